@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""End-to-end Jalali reporting workload.
+
+Generates a star-schema sales fact table (100M rows by default) and runs typical Jalali reporting queries
+against it. Every query is paired with a baseline that has the same plan shape with the Jalali functions replaced
+by built-in Gregorian equivalents. The report shows the median latency of both, and the share of the Jalali
+query's time that goes into Jalali functions, estimated as (jalali - baseline) / jalali.
+
+Usage:
+    python3 benchmark/jalali_workload.py [--rows N] [--runs N] [--threads N] [--database FILE] [--only NAME ...]
+
+Requires the duckdb Python package of the DuckDB version the extension is built against. The extension is loaded
+from build/release by default. Pass --database to keep the generated data between runs; tables that already
+exist are reused.
+"""
+
+import argparse
+import os
+import shutil
+import statistics
+import sys
+import tempfile
+import time
+
+import duckdb
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_EXTENSION = os.path.join(REPO_DIR, 'build', 'release', 'extension', 'jalali', 'jalali.duckdb_extension')
+
+# 1398-01-01 to 1403-01-01 in seconds: five Jalali years of sales
+START = "TIMESTAMP '2019-03-21'"
+SPAN_SECONDS = 5 * 365 * 86400
+
+SCHEMA = [
+    (
+        'dim_customer',
+        """
+        CREATE TABLE dim_customer AS
+        SELECT i AS customer_id,
+               ['retail', 'wholesale', 'online', 'corporate'][1 + hash(i, 'segment') % 4] AS segment
+        FROM range({customers}) t(i)
+        """,
+    ),
+    (
+        'dim_product',
+        """
+        CREATE TABLE dim_product AS
+        SELECT i AS product_id, 'category_' || (hash(i, 'category') % 50) AS category
+        FROM range({products}) t(i)
+        """,
+    ),
+    (
+        'fact_sales',
+        """
+        CREATE TABLE fact_sales AS
+        SELECT i AS sale_id,
+               ts,
+               hash(i, 'customer') % {customers} AS customer_id,
+               hash(i, 'product') % {products} AS product_id,
+               (hash(i, 'amount') % 100000) / 100.0 AS amount,
+               gregorian_to_jalali(ts, 'date') AS jalali_text,
+               strftime(ts, '%Y-%m-%d') AS gregorian_text
+        FROM (SELECT i, {start} + to_seconds((hash(i) % {span})::BIGINT) AS ts FROM range({rows}) t(i))
+        """,
+    ),
+]
+
+SETUP = ["PRAGMA jalali_create_fiscal_calendar('benchmark_fy', 4, 'month')"]
+
+# name -> (Jalali query, baseline query). {export} is replaced by a scratch file path.
+QUERIES = {
+    'monthly_revenue': (
+        """
+        SELECT substr(gregorian_to_jalali(ts, 'date'), 1, 7) AS month, sum(amount)
+        FROM fact_sales GROUP BY ALL ORDER BY ALL
+        """,
+        """
+        SELECT strftime(ts, '%Y-%m') AS month, sum(amount)
+        FROM fact_sales GROUP BY ALL ORDER BY ALL
+        """,
+    ),
+    'monthly_revenue_by_id': (
+        """
+        SELECT jalali_month(ts) AS month, p.category, sum(amount)
+        FROM fact_sales JOIN dim_product p USING (product_id) GROUP BY ALL
+        """,
+        """
+        SELECT date_trunc('month', ts) AS month, p.category, sum(amount)
+        FROM fact_sales JOIN dim_product p USING (product_id) GROUP BY ALL
+        """,
+    ),
+    'fiscal_ytd': (
+        """
+        SELECT segment, fy, max(ytd)
+        FROM (
+            SELECT c.segment, jalali_fiscal_year(ts, 'benchmark_fy') AS fy,
+                   sum(amount) OVER (PARTITION BY c.segment, jalali_fiscal_year(ts, 'benchmark_fy') ORDER BY ts) AS ytd
+            FROM fact_sales JOIN dim_customer c USING (customer_id))
+        GROUP BY ALL
+        """,
+        """
+        SELECT segment, fy, max(ytd)
+        FROM (
+            SELECT c.segment, year(ts + INTERVAL 6 MONTH) AS fy,
+                   sum(amount) OVER (PARTITION BY c.segment, year(ts + INTERVAL 6 MONTH) ORDER BY ts) AS ytd
+            FROM fact_sales JOIN dim_customer c USING (customer_id))
+        GROUP BY ALL
+        """,
+    ),
+    'cohort_retention': (
+        """
+        SELECT jalali_period_id(jalali_activity_first(days), 'month') AS cohort, count(*) AS customers,
+               sum(r[2]::INTEGER) AS month_1, sum(r[4]::INTEGER) AS month_3, sum(r[7]::INTEGER) AS month_6
+        FROM (
+            SELECT jalali_activity(ts) AS days, jalali_retention(jalali_activity(ts), 'month', 7) AS r
+            FROM fact_sales GROUP BY customer_id)
+        GROUP BY ALL
+        """,
+        """
+        SELECT cohort, count(*) AS customers,
+               sum(list_contains(months, cohort + INTERVAL 1 MONTH)::INTEGER) AS month_1,
+               sum(list_contains(months, cohort + INTERVAL 3 MONTH)::INTEGER) AS month_3,
+               sum(list_contains(months, cohort + INTERVAL 6 MONTH)::INTEGER) AS month_6
+        FROM (
+            SELECT min(date_trunc('month', ts)) AS cohort, list(DISTINCT date_trunc('month', ts)) AS months
+            FROM fact_sales GROUP BY customer_id)
+        GROUP BY ALL
+        """,
+    ),
+    'filtered_export': (
+        """
+        COPY (
+            SELECT sale_id, gregorian_to_jalali(ts, 'datetime', true) AS sold_at, amount
+            FROM fact_sales WHERE jalali_month(ts) = '1401-05'::JALALI_MONTH)
+        TO '{export}' (HEADER)
+        """,
+        """
+        COPY (
+            SELECT sale_id, strftime(ts, '%Y-%m-%d %H:%M:%S') AS sold_at, amount
+            FROM fact_sales WHERE date_trunc('month', ts) = DATE '2022-07-01')
+        TO '{export}' (HEADER)
+        """,
+    ),
+    'legacy_text_filter': (
+        """
+        SELECT count(*), sum(amount) FROM fact_sales
+        WHERE jalali_to_gregorian(jalali_text, false) BETWEEN TIMESTAMP '2022-03-21' AND TIMESTAMP '2023-03-20'
+        """,
+        """
+        SELECT count(*), sum(amount) FROM fact_sales
+        WHERE gregorian_text::TIMESTAMP BETWEEN TIMESTAMP '2022-03-21' AND TIMESTAMP '2023-03-20'
+        """,
+    ),
+}
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Run the Jalali reporting workload benchmark')
+    parser.add_argument('--rows', type=int, default=100_000_000, help='fact table rows (default 100M)')
+    parser.add_argument('--runs', type=int, default=3, help='timed runs per query, after one warm-up run')
+    parser.add_argument('--threads', type=int, default=None, help='DuckDB threads (default: all cores)')
+    parser.add_argument('--database', default=':memory:', help='database file, to reuse generated data')
+    parser.add_argument('--extension', default=DEFAULT_EXTENSION, help='path of jalali.duckdb_extension')
+    parser.add_argument('--only', nargs='*', choices=sorted(QUERIES), help='run only these queries')
+    return parser.parse_args()
+
+
+def connect(args):
+    con = duckdb.connect(args.database, config={'allow_unsigned_extensions': 'true'})
+    con.execute(f"LOAD '{args.extension}'")
+    if args.threads:
+        con.execute(f'SET threads = {args.threads}')
+    return con
+
+
+def generate(con, rows):
+    existing = {name for (name,) in con.execute('SELECT table_name FROM duckdb_tables()').fetchall()}
+    sizes = {
+        'rows': rows,
+        'customers': max(rows // 100, 1),
+        'products': 10_000,
+        'start': START,
+        'span': SPAN_SECONDS,
+    }
+    for name, sql in SCHEMA:
+        if name in existing:
+            continue
+        began = time.perf_counter()
+        con.execute(sql.format(**sizes))
+        print(f'generated {name} in {time.perf_counter() - began:.1f}s', file=sys.stderr)
+    for sql in SETUP:
+        con.execute(sql)
+
+
+def timed(con, sql, runs):
+    con.execute(sql).fetchall()
+    timings = []
+    for _ in range(runs):
+        began = time.perf_counter()
+        con.execute(sql).fetchall()
+        timings.append(time.perf_counter() - began)
+    return statistics.median(timings)
+
+
+def main():
+    args = parse_args()
+    con = connect(args)
+    generate(con, args.rows)
+    rows = con.execute('SELECT count(*) FROM fact_sales').fetchone()[0]
+
+    scratch = tempfile.mkdtemp(prefix='jalali_workload_')
+    try:
+        print(f'\n{rows:,} fact rows, median of {args.runs} runs\n')
+        print(f"{'query':<24}{'jalali (s)':>12}{'baseline (s)':>14}{'jalali share':>14}")
+        total_jalali = total_baseline = 0.0
+        for name in args.only or QUERIES:
+            export = os.path.join(scratch, f'{name}.csv')
+            jalali_sql, baseline_sql = (sql.replace('{export}', export) for sql in QUERIES[name])
+            jalali_time = timed(con, jalali_sql, args.runs)
+            baseline_time = timed(con, baseline_sql, args.runs)
+            share = max(jalali_time - baseline_time, 0.0) / jalali_time if jalali_time > 0 else 0.0
+            total_jalali += jalali_time
+            total_baseline += baseline_time
+            print(f'{name:<24}{jalali_time:>12.3f}{baseline_time:>14.3f}{share:>13.1%}')
+        total_share = max(total_jalali - total_baseline, 0.0) / total_jalali if total_jalali > 0 else 0.0
+        print(f"{'total':<24}{total_jalali:>12.3f}{total_baseline:>14.3f}{total_share:>13.1%}")
+    finally:
+        shutil.rmtree(scratch, ignore_errors=True)
+
+
+if __name__ == '__main__':
+    main()
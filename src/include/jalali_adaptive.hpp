@@ -0,0 +1,221 @@
+#pragma once
+
+#include "jalali_calendar.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+#include <atomic>
+#include <chrono>
+
+namespace duckdb {
+
+// Ways to turn day numbers into Jalali date fields. They give the same results; which one is fastest depends on
+// the data: the cache on low-cardinality columns, the table on clustered dates, arithmetic on random wide ranges.
+enum class JalaliDaysStrategy : uint8_t { ARITHMETIC, CACHE, TABLE };
+
+struct JalaliDateSlot {
+    int32_t year;
+    int32_t month_day;
+
+    inline void Set(int32_t days) {
+        int32_t jm, jd;
+        JalaliCalendar::FromDays(days, year, jm, jd);
+        month_day = jm * 32 + jd;
+    }
+
+    inline void Get(int32_t &jy, int32_t &jm, int32_t &jd) const {
+        jy = year;
+        jm = month_day / 32;
+        jd = month_day % 32;
+    }
+};
+
+// Direct-mapped cache of recently converted days
+struct JalaliDayCache {
+    static constexpr idx_t SIZE = 1024;
+
+    int32_t keys[SIZE];
+    JalaliDateSlot slots[SIZE];
+
+    JalaliDayCache() {
+        for (idx_t i = 0; i < SIZE; i++) {
+            keys[i] = NumericLimits<int32_t>::Minimum();
+        }
+    }
+
+    void FromDays(const int32_t *days, int32_t *jy, int32_t *jm, int32_t *jd, idx_t count) {
+        for (idx_t i = 0; i < count; i++) {
+            auto slot = uint32_t(days[i]) & (SIZE - 1);
+            if (keys[slot] != days[i]) {
+                keys[slot] = days[i];
+                slots[slot].Set(days[i]);
+            }
+            slots[slot].Get(jy[i], jm[i], jd[i]);
+        }
+    }
+};
+
+// Precomputed window of consecutive days, centred on the data it first sees; days outside it use arithmetic
+struct JalaliDayTable {
+    static constexpr idx_t SIZE = 4096;
+
+    bool initialized = false;
+    int32_t base = 0;
+    JalaliDateSlot slots[SIZE];
+
+    void Build(int32_t center) {
+        base = int32_t(MaxValue<int64_t>(int64_t(center) - int64_t(SIZE / 2), NumericLimits<int32_t>::Minimum()));
+        for (idx_t i = 0; i < SIZE; i++) {
+            slots[i].Set(int32_t(int64_t(base) + int64_t(i)));
+        }
+        initialized = true;
+    }
+
+    void FromDays(const int32_t *days, int32_t *jy, int32_t *jm, int32_t *jd, idx_t count) {
+        if (count == 0) {
+            return;
+        }
+        if (!initialized) {
+            Build(days[0]);
+        }
+        for (idx_t i = 0; i < count; i++) {
+            auto offset = uint64_t(int64_t(days[i]) - int64_t(base));
+            if (offset < SIZE) {
+                slots[offset].Get(jy[i], jm[i], jd[i]);
+            } else {
+                JalaliCalendar::FromDays(days[i], jy[i], jm[i], jd[i]);
+            }
+        }
+    }
+};
+
+// Per-database counters of the strategies chosen, reported by jalali_stats()
+class JalaliStats : public ObjectCacheEntry {
+public:
+    static constexpr idx_t STRATEGY_COUNT = 3;
+
+    static string ObjectType() {
+        return "jalali_stats";
+    }
+
+    string GetObjectType() override {
+        return ObjectType();
+    }
+
+    static shared_ptr<JalaliStats> Get(ClientContext &context) {
+        return ObjectCache::GetObjectCache(context).GetOrCreate<JalaliStats>(ObjectType());
+    }
+
+    static const char *StrategyName(idx_t strategy) {
+        static const char *const NAMES[] = {"arithmetic", "cache", "table"};
+        return NAMES[strategy];
+    }
+
+    // Times a strategy was settled on after sampling
+    std::atomic<uint64_t> decisions[STRATEGY_COUNT] = {};
+    // Vectors and rows converted with each strategy, including sampling
+    std::atomic<uint64_t> vectors[STRATEGY_COUNT] = {};
+    std::atomic<uint64_t> rows[STRATEGY_COUNT] = {};
+};
+
+// Picks the fastest strategy per thread, in the spirit of DuckDB's adaptive filter: the first vectors rotate
+// through all strategies and are timed, then the fastest runs until the next re-check, which samples again.
+class JalaliAdaptiveFromDays {
+public:
+    static constexpr idx_t STRATEGY_COUNT = JalaliStats::STRATEGY_COUNT;
+    // The first round warms up the cache and the table and is not timed
+    static constexpr idx_t SAMPLE_ROUNDS = 4;
+    static constexpr idx_t RECHECK_VECTORS = 512;
+
+    void Initialize(shared_ptr<JalaliStats> stats_p) {
+        stats = std::move(stats_p);
+    }
+
+    void FromDays(const int32_t *days, int32_t *jy, int32_t *jm, int32_t *jd, idx_t count) {
+        if (!sampling && ++vectors_since_check >= RECHECK_VECTORS) {
+            StartSampling();
+        }
+        auto strategy = sampling ? JalaliDaysStrategy(sample_index % STRATEGY_COUNT) : current;
+        bool timed = sampling && sample_index >= STRATEGY_COUNT;
+
+        auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        Run(strategy, days, jy, jm, jd, count);
+        if (timed) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            sample_nanos[idx_t(strategy)] += double(nanos);
+            sample_rows[idx_t(strategy)] += count;
+        }
+        if (stats) {
+            stats->vectors[idx_t(strategy)].fetch_add(1, std::memory_order_relaxed);
+            stats->rows[idx_t(strategy)].fetch_add(count, std::memory_order_relaxed);
+        }
+        if (sampling && ++sample_index == SAMPLE_ROUNDS * STRATEGY_COUNT) {
+            Decide();
+        }
+    }
+
+    JalaliDaysStrategy Current() const {
+        return current;
+    }
+
+private:
+    void Run(JalaliDaysStrategy strategy, const int32_t *days, int32_t *jy, int32_t *jm, int32_t *jd, idx_t count) {
+        switch (strategy) {
+        case JalaliDaysStrategy::CACHE:
+            cache.FromDays(days, jy, jm, jd, count);
+            break;
+        case JalaliDaysStrategy::TABLE:
+            table.FromDays(days, jy, jm, jd, count);
+            break;
+        default:
+            JalaliCalendar::FromDays(days, jy, jm, jd, count);
+            break;
+        }
+    }
+
+    void StartSampling() {
+        sampling = true;
+        sample_index = 0;
+        vectors_since_check = 0;
+        // Re-centre the table on the data seen from now on
+        table.initialized = false;
+        for (idx_t s = 0; s < STRATEGY_COUNT; s++) {
+            sample_nanos[s] = 0;
+            sample_rows[s] = 0;
+        }
+    }
+
+    void Decide() {
+        idx_t best = 0;
+        double best_cost = NumericLimits<double>::Maximum();
+        for (idx_t s = 0; s < STRATEGY_COUNT; s++) {
+            if (sample_rows[s] == 0) {
+                continue;
+            }
+            auto cost = sample_nanos[s] / double(sample_rows[s]);
+            if (cost < best_cost) {
+                best = s;
+                best_cost = cost;
+            }
+        }
+        current = JalaliDaysStrategy(best);
+        sampling = false;
+        vectors_since_check = 0;
+        if (stats) {
+            stats->decisions[best].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    JalaliDayCache cache;
+    JalaliDayTable table;
+    shared_ptr<JalaliStats> stats;
+
+    JalaliDaysStrategy current = JalaliDaysStrategy::ARITHMETIC;
+    bool sampling = true;
+    idx_t sample_index = 0;
+    idx_t vectors_since_check = 0;
+    double sample_nanos[STRATEGY_COUNT] = {};
+    idx_t sample_rows[STRATEGY_COUNT] = {};
+};
+
+} // namespace duckdb
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "jalali_calendar.hpp"
+#include "duckdb/main/appender.hpp"
+
+namespace duckdb {
+
+// Wraps an Appender and converts Jalali text or date parts to DATE/TIMESTAMP values as they are appended, so
+// Jalali input is ingested in a single pass. Parsing goes through the allocation-free JalaliParser; invalid
+// input throws an InvalidInputException. Other values are forwarded to the wrapped Appender unchanged.
+//
+//     Appender appender(con, "events");
+//     JalaliAppender jalali(appender);
+//     jalali.BeginRow();
+//     jalali.Append<int32_t>(42);
+//     jalali.AppendJalaliTimestamp("1402-05-12 10:15:30");
+//     jalali.EndRow();
+//     jalali.Close();
+class JalaliAppender {
+public:
+    explicit JalaliAppender(Appender &appender) : appender(appender) {
+    }
+
+    Appender &GetAppender() {
+        return appender;
+    }
+
+    void BeginRow() {
+        appender.BeginRow();
+    }
+
+    void EndRow() {
+        appender.EndRow();
+    }
+
+    template <class T>
+    void Append(T value) {
+        appender.Append<T>(value);
+    }
+
+    void AppendNull() {
+        appender.Append(Value());
+    }
+
+    void Flush() {
+        appender.Flush();
+    }
+
+    void Close() {
+        appender.Close();
+    }
+
+    // Append "YYYY-MM-DD" as a DATE; a time part is not allowed
+    void AppendJalaliDate(const char *data, idx_t length) {
+        JalaliParts parts;
+        Parse(data, length, parts);
+        if (parts.has_time) {
+            throw InvalidInputException("Expected a Jalali date without time: \"%s\"", string(data, length));
+        }
+        appender.Append<date_t>(date_t(JalaliCalendar::ToDays(parts.year, parts.month, parts.day)));
+    }
+
+    void AppendJalaliDate(const string &value) {
+        AppendJalaliDate(value.c_str(), value.size());
+    }
+
+    void AppendJalaliDate(int32_t year, int32_t month, int32_t day) {
+        CheckDate(year, month, day);
+        appender.Append<date_t>(date_t(JalaliCalendar::ToDays(year, month, day)));
+    }
+
+    // Append "YYYY-MM-DD[ HH:MM[:SS]]" as a TIMESTAMP; a time with a UTC offset is normalized to UTC
+    void AppendJalaliTimestamp(const char *data, idx_t length) {
+        JalaliParts parts;
+        Parse(data, length, parts);
+        auto days = JalaliCalendar::ToDays(parts.year, parts.month, parts.day);
+        appender.Append<timestamp_t>(MakeTimestamp(days, parts.micros - parts.offset_micros));
+    }
+
+    void AppendJalaliTimestamp(const string &value) {
+        AppendJalaliTimestamp(value.c_str(), value.size());
+    }
+
+    void AppendJalaliTimestamp(int32_t year, int32_t month, int32_t day, int32_t hour, int32_t minute,
+                               int32_t second, int32_t micros = 0) {
+        CheckDate(year, month, day);
+        if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59 || micros < 0 ||
+            micros >= Interval::MICROS_PER_SEC) {
+            throw InvalidInputException("Invalid time %02d:%02d:%02d.%06d", hour, minute, second, micros);
+        }
+        auto time_micros = (int64_t(hour) * 3600 + minute * 60 + second) * Interval::MICROS_PER_SEC + micros;
+        appender.Append<timestamp_t>(MakeTimestamp(JalaliCalendar::ToDays(year, month, day), time_micros));
+    }
+
+private:
+    static void CheckDate(int32_t year, int32_t month, int32_t day) {
+        if (!JalaliCalendar::YearInRange(year)) {
+            throw InvalidInputException("Jalali date out of range: %d-%02d-%02d", year, month, day);
+        }
+        if (!JalaliCalendar::IsValid(year, month, day)) {
+            throw InvalidInputException("Invalid Jalali date %04d-%02d-%02d", year, month, day);
+        }
+    }
+
+    static timestamp_t MakeTimestamp(int32_t days, int64_t micros) {
+        timestamp_t result;
+        if (!JalaliCalendar::TryMakeTimestamp(days, micros, result)) {
+            throw InvalidInputException("Jalali date out of range: day %d is outside the TIMESTAMP range", days);
+        }
+        return result;
+    }
+
+    static void Parse(const char *data, idx_t length, JalaliParts &parts) {
+        if (!JalaliParser::TryParse(data, length, parts)) {
+            throw InvalidInputException("Invalid Jalali date format. Expected format: YYYY-MM-DD: \"%s\"",
+                                        string(data, length));
+        }
+        CheckDate(parts.year, parts.month, parts.day);
+    }
+
+    Appender &appender;
+};
+
+} // namespace duckdb
@@ -0,0 +1,595 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/operator/add.hpp"
+#include "duckdb/common/operator/multiply.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/interval.hpp"
+#include "duckdb/common/types/string_type.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+namespace duckdb {
+
+// Calendar periods the period-based functions group by. Weeks start on Saturday.
+enum class JalaliPeriod : uint8_t { DAY, WEEK, MONTH, QUARTER, YEAR };
+
+// Jalali calendar arithmetic shared by the extension's functions.
+// Day numbers are DuckDB date_t days (days since 1970-01-01), so a day number converts to a
+// DATE or TIMESTAMP without any further calendar math.
+struct JalaliCalendar {
+    // Days in one 33-year cycle of the arithmetic calendar
+    static constexpr int32_t CYCLE_DAYS = 12053;
+    // First year of the cycle arithmetic and its 1 Farvardin as a day number (1600-03-20)
+    static constexpr int32_t EPOCH_YEAR = 979;
+    static constexpr int32_t EPOCH_DAYS = -135061;
+    // Years ToDays accepts from untrusted input. The day number arithmetic stays within int32 for these, and they
+    // cover the whole TIMESTAMP range; TryMakeTimestamp rejects the dates at the edges that do not fit.
+    static constexpr int32_t MIN_YEAR = -300000;
+    static constexpr int32_t MAX_YEAR = 300000;
+    // Time of day used for the end_of_day flag (23:59:59)
+    static constexpr int64_t END_OF_DAY_MICROS = 86399 * Interval::MICROS_PER_SEC;
+
+    static inline int32_t FloorDiv(int32_t a, int32_t b) {
+        int32_t q = a / b;
+        return q - ((a % b != 0) & ((a < 0) != (b < 0)));
+    }
+
+    static inline int64_t FloorDiv(int64_t a, int64_t b) {
+        int64_t q = a / b;
+        return q - ((a % b != 0) & ((a < 0) != (b < 0)));
+    }
+
+    // Day of the year (0-based) on which the given month starts
+    static inline int32_t MonthOffset(int32_t jm) {
+        jm = jm < 1 ? 1 : jm;
+        return jm <= 7 ? (jm - 1) * 31 : 186 + (jm - 7) * 30;
+    }
+
+    // Jalali date to day number
+    static inline int32_t ToDays(int32_t jy, int32_t jm, int32_t jd) {
+        int32_t y = jy - EPOCH_YEAR;
+        int32_t cycles = FloorDiv(y, 33);
+        int32_t r = y - cycles * 33;
+        return EPOCH_DAYS + cycles * CYCLE_DAYS + 365 * r + (r + 3) / 4 + MonthOffset(jm) + jd - 1;
+    }
+
+    // Day number to Jalali date
+    static inline void FromDays(int32_t days, int32_t &jy, int32_t &jm, int32_t &jd) {
+        int32_t j = days - EPOCH_DAYS;
+        int32_t cycles = FloorDiv(j, CYCLE_DAYS);
+        j -= cycles * CYCLE_DAYS;
+        jy = EPOCH_YEAR + 33 * cycles + 4 * (j / 1461);
+        j %= 1461;
+        if (j >= 366) {
+            jy += (j - 1) / 365;
+            j = (j - 1) % 365;
+        }
+        jm = j < 186 ? j / 31 + 1 : (j - 186) / 30 + 7;
+        jd = j < 186 ? j % 31 + 1 : (j - 186) % 30 + 1;
+    }
+
+    static inline bool IsLeapYear(int32_t jy) {
+        int32_t y = jy - EPOCH_YEAR;
+        int32_t r = y - FloorDiv(y, 33) * 33;
+        return r % 4 == 0 && r != 32;
+    }
+
+    static inline int32_t MonthDays(int32_t jy, int32_t jm) {
+        if (jm <= 6) {
+            return 31;
+        }
+        if (jm <= 11) {
+            return 30;
+        }
+        return IsLeapYear(jy) ? 30 : 29;
+    }
+
+    static inline bool IsValid(int32_t jy, int32_t jm, int32_t jd) {
+        return jm >= 1 && jm <= 12 && jd >= 1 && jd <= MonthDays(jy, jm);
+    }
+
+    // Split a timestamp into its day number and time of day
+    static inline void SplitTimestamp(timestamp_t ts, int32_t &days, int64_t &micros) {
+        int64_t d = FloorDiv(ts.value, Interval::MICROS_PER_DAY);
+        days = int32_t(d);
+        micros = ts.value - d * Interval::MICROS_PER_DAY;
+    }
+
+    static inline timestamp_t MakeTimestamp(int32_t days, int64_t micros) {
+        return timestamp_t(int64_t(days) * Interval::MICROS_PER_DAY + micros);
+    }
+
+    static inline bool YearInRange(int32_t jy) {
+        return jy >= MIN_YEAR && jy <= MAX_YEAR;
+    }
+
+    // MakeTimestamp for parsed input; false when the result does not fit a finite TIMESTAMP
+    static inline bool TryMakeTimestamp(int32_t days, int64_t micros, timestamp_t &result) {
+        int64_t value;
+        if (!TryMultiplyOperator::Operation<int64_t, int64_t, int64_t>(int64_t(days), Interval::MICROS_PER_DAY,
+                                                                        value) ||
+            !TryAddOperator::Operation<int64_t, int64_t, int64_t>(value, micros, value)) {
+            return false;
+        }
+        result = timestamp_t(value);
+        return Timestamp::IsFinite(result);
+    }
+
+    // Day number of the first Saturday on or after 1970-01-01
+    static constexpr int32_t FIRST_SATURDAY = 2;
+
+    static JalaliPeriod ParsePeriod(const string &name) {
+        auto lower = StringUtil::Lower(name);
+        if (lower == "day") {
+            return JalaliPeriod::DAY;
+        } else if (lower == "week") {
+            return JalaliPeriod::WEEK;
+        } else if (lower == "month") {
+            return JalaliPeriod::MONTH;
+        } else if (lower == "quarter") {
+            return JalaliPeriod::QUARTER;
+        } else if (lower == "year") {
+            return JalaliPeriod::YEAR;
+        }
+        throw InvalidInputException("Unsupported Jalali period \"%s\", expected day, week, month, quarter or year",
+                                    name);
+    }
+
+    // Sequential id of the period containing a day number. Consecutive periods have consecutive ids:
+    // days and weeks count from 1970, months are year * 12 + month - 1, quarters year * 4 + quarter - 1.
+    static inline int32_t PeriodId(int32_t days, JalaliPeriod period) {
+        if (period == JalaliPeriod::DAY) {
+            return days;
+        }
+        if (period == JalaliPeriod::WEEK) {
+            return FloorDiv(days - FIRST_SATURDAY, 7);
+        }
+        int32_t jy, jm, jd;
+        FromDays(days, jy, jm, jd);
+        switch (period) {
+        case JalaliPeriod::MONTH:
+            return jy * 12 + jm - 1;
+        case JalaliPeriod::QUARTER:
+            return jy * 4 + (jm - 1) / 3;
+        default:
+            return jy;
+        }
+    }
+
+    // First day number of a period id
+    static inline int32_t PeriodStart(int32_t id, JalaliPeriod period) {
+        switch (period) {
+        case JalaliPeriod::DAY:
+            return id;
+        case JalaliPeriod::WEEK:
+            return id * 7 + FIRST_SATURDAY;
+        case JalaliPeriod::MONTH:
+            return ToDays(FloorDiv(id, 12), id - FloorDiv(id, 12) * 12 + 1, 1);
+        case JalaliPeriod::QUARTER:
+            return ToDays(FloorDiv(id, 4), (id - FloorDiv(id, 4) * 4) * 3 + 1, 1);
+        default:
+            return ToDays(id, 1, 1);
+        }
+    }
+
+    // Columnar versions of the above, written as plain loops so they auto-vectorize
+    static void ToDays(const int32_t *jy, const int32_t *jm, const int32_t *jd, int32_t *days, idx_t count) {
+        for (idx_t i = 0; i < count; i++) {
+            days[i] = ToDays(jy[i], jm[i], jd[i]);
+        }
+    }
+
+    static void FromDays(const int32_t *days, int32_t *jy, int32_t *jm, int32_t *jd, idx_t count) {
+        for (idx_t i = 0; i < count; i++) {
+            FromDays(days[i], jy[i], jm[i], jd[i]);
+        }
+    }
+};
+
+// Fields of a parsed Jalali date/time string
+struct JalaliParts {
+    int32_t year = 0;
+    int32_t month = 0;
+    int32_t day = 0;
+    int64_t micros = 0;
+    // UTC offset of the time, e.g. +03:30; a UTC timestamp is micros - offset_micros
+    int64_t offset_micros = 0;
+    bool has_time = false;
+    bool has_offset = false;
+    // False when the hour, minute or second is past 23:59:59; lenient callers let such a time roll over
+    bool time_in_range = true;
+};
+
+// Allocation-free parser for "YYYY-MM-DD[( |T)HH:MM[:SS[.ffffff]][Z|+HH:MM|-HH:MM]]"
+struct JalaliParser {
+    static inline bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static inline bool IsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    static inline bool ParseNumber(const char *data, idx_t len, idx_t &pos, int32_t &result, idx_t max_digits) {
+        idx_t start = pos;
+        int32_t value = 0;
+        while (pos < len && IsDigit(data[pos]) && pos - start < max_digits) {
+            value = value * 10 + (data[pos] - '0');
+            pos++;
+        }
+        result = value;
+        return pos > start;
+    }
+
+    // Accept exactly the canonical "YYYY-MM-DD" layout written by the date output mode: no whitespace, no time,
+    // zero-padded fields and a valid date, so that formatting the result reproduces the input byte for byte
+    static bool TryParseCanonical(const char *data, idx_t len, int32_t &jy, int32_t &jm, int32_t &jd) {
+        if (len != 10 || data[4] != '-' || data[7] != '-') {
+            return false;
+        }
+        for (idx_t i = 0; i < len; i++) {
+            if (i != 4 && i != 7 && !IsDigit(data[i])) {
+                return false;
+            }
+        }
+        jy = (data[0] - '0') * 1000 + (data[1] - '0') * 100 + (data[2] - '0') * 10 + (data[3] - '0');
+        jm = (data[5] - '0') * 10 + (data[6] - '0');
+        jd = (data[8] - '0') * 10 + (data[9] - '0');
+        return JalaliCalendar::IsValid(jy, jm, jd);
+    }
+
+    static bool TryParse(const char *data, idx_t len, JalaliParts &parts) {
+        idx_t pos = 0;
+        while (pos < len && IsSpace(data[pos])) {
+            pos++;
+        }
+        // Date part
+        if (!ParseNumber(data, len, pos, parts.year, 9)) {
+            return false;
+        }
+        if (pos >= len || data[pos] != '-') {
+            return false;
+        }
+        pos++;
+        if (!ParseNumber(data, len, pos, parts.month, 2)) {
+            return false;
+        }
+        if (pos >= len || data[pos] != '-') {
+            return false;
+        }
+        pos++;
+        if (!ParseNumber(data, len, pos, parts.day, 2)) {
+            return false;
+        }
+        // Optional time part, after whitespace or an ISO-8601 'T'
+        parts.micros = 0;
+        parts.offset_micros = 0;
+        parts.has_time = false;
+        parts.has_offset = false;
+        parts.time_in_range = true;
+        idx_t time_start = pos;
+        if (pos < len && data[pos] == 'T') {
+            pos++;
+            if (pos >= len || !IsDigit(data[pos])) {
+                return false;
+            }
+        } else {
+            while (pos < len && IsSpace(data[pos])) {
+                pos++;
+            }
+        }
+        if (pos < len && pos > time_start) {
+            int32_t hour, minute, second = 0;
+            int64_t fraction = 0;
+            if (!ParseNumber(data, len, pos, hour, 2)) {
+                return false;
+            }
+            if (pos >= len || data[pos] != ':') {
+                return false;
+            }
+            pos++;
+            if (!ParseNumber(data, len, pos, minute, 2)) {
+                return false;
+            }
+            if (pos < len && data[pos] == ':') {
+                pos++;
+                if (!ParseNumber(data, len, pos, second, 2)) {
+                    return false;
+                }
+                if (pos < len && data[pos] == '.' && !ParseFraction(data, len, ++pos, fraction)) {
+                    return false;
+                }
+            }
+            parts.micros = (int64_t(hour) * 3600 + minute * 60 + second) * Interval::MICROS_PER_SEC + fraction;
+            parts.has_time = true;
+            parts.time_in_range = hour <= 23 && minute <= 59 && second <= 59;
+            // Optional UTC offset, directly after the time or after whitespace
+            idx_t offset_start = pos;
+            while (pos < len && IsSpace(data[pos])) {
+                pos++;
+            }
+            if (pos < len && (data[pos] == 'Z' || data[pos] == '+' || data[pos] == '-')) {
+                if (!ParseOffset(data, len, pos, parts)) {
+                    return false;
+                }
+            } else {
+                pos = offset_start;
+            }
+        }
+        while (pos < len && IsSpace(data[pos])) {
+            pos++;
+        }
+        return pos == len;
+    }
+
+    // Fractional seconds: 1 to 9 digits, kept to microsecond precision
+    static bool ParseFraction(const char *data, idx_t len, idx_t &pos, int64_t &fraction) {
+        idx_t digits = 0;
+        fraction = 0;
+        while (pos < len && IsDigit(data[pos])) {
+            if (digits < 6) {
+                fraction = fraction * 10 + (data[pos] - '0');
+            }
+            digits++;
+            pos++;
+        }
+        for (auto d = digits; d < 6; d++) {
+            fraction *= 10;
+        }
+        return digits > 0 && digits <= 9;
+    }
+
+    // "Z", "+HH", "+HH:MM" or "+HHMM" (and the same with '-')
+    static bool ParseOffset(const char *data, idx_t len, idx_t &pos, JalaliParts &parts) {
+        parts.has_offset = true;
+        if (data[pos] == 'Z') {
+            pos++;
+            return true;
+        }
+        bool negative = data[pos] == '-';
+        pos++;
+        int32_t hours, minutes = 0;
+        idx_t start = pos;
+        if (!ParseNumber(data, len, pos, hours, 2) || pos - start != 2) {
+            return false;
+        }
+        if (pos < len && data[pos] == ':') {
+            pos++;
+        }
+        if (pos < len && IsDigit(data[pos])) {
+            start = pos;
+            if (!ParseNumber(data, len, pos, minutes, 2) || pos - start != 2) {
+                return false;
+            }
+        }
+        if (hours > 23 || minutes > 59) {
+            return false;
+        }
+        parts.offset_micros = (int64_t(hours) * 60 + minutes) * Interval::MICROS_PER_MINUTE;
+        if (negative) {
+            parts.offset_micros = -parts.offset_micros;
+        }
+        return true;
+    }
+
+    static void Parse(const string_t &input, JalaliParts &parts) {
+        if (!TryParse(input.GetData(), input.GetSize(), parts)) {
+            throw InvalidInputException("Invalid Jalali date format. Expected format: YYYY-MM-DD");
+        }
+        if (!JalaliCalendar::YearInRange(parts.year)) {
+            throw InvalidInputException("Jalali date out of range: \"%s\"", input.GetString());
+        }
+    }
+};
+
+// Text layouts gregorian_to_jalali can produce. AUTO drops the time when it is exactly midnight, every
+// other mode always emits the same width.
+enum class JalaliOutputMode : uint8_t { AUTO, DATE, DATETIME, DATETIME_MICROS, COMPACT };
+
+// Writes Jalali dates and times as text without going through snprintf
+struct JalaliFormatter {
+    static constexpr idx_t DATE_LENGTH = 10;
+    static constexpr idx_t DATETIME_LENGTH = 19;
+    static constexpr idx_t DATETIME_MICROS_LENGTH = 26;
+    static constexpr idx_t COMPACT_LENGTH = 8;
+    static constexpr idx_t MAX_LENGTH = 48;
+
+    static JalaliOutputMode ParseMode(const string &name) {
+        auto lower = StringUtil::Lower(name);
+        if (lower == "auto") {
+            return JalaliOutputMode::AUTO;
+        } else if (lower == "date") {
+            return JalaliOutputMode::DATE;
+        } else if (lower == "datetime") {
+            return JalaliOutputMode::DATETIME;
+        } else if (lower == "datetime_micros") {
+            return JalaliOutputMode::DATETIME_MICROS;
+        } else if (lower == "compact") {
+            return JalaliOutputMode::COMPACT;
+        }
+        throw InvalidInputException(
+            "Unsupported Jalali output mode \"%s\", expected auto, date, datetime, datetime_micros or compact", name);
+    }
+
+    static inline void WriteTwoDigits(char *out, int32_t value) {
+        out[0] = char('0' + value / 10);
+        out[1] = char('0' + value % 10);
+    }
+
+    static inline bool YearFits(int32_t jy) {
+        return jy >= 0 && jy <= 9999;
+    }
+
+    // "YYYY-MM-DD"; the year must satisfy YearFits
+    static inline void WriteDate(char *out, int32_t jy, int32_t jm, int32_t jd) {
+        WriteTwoDigits(out, jy / 100);
+        WriteTwoDigits(out + 2, jy % 100);
+        out[4] = '-';
+        WriteTwoDigits(out + 5, jm);
+        out[7] = '-';
+        WriteTwoDigits(out + 8, jd);
+    }
+
+    // "YYYYMMDD"; the year must satisfy YearFits
+    static inline void WriteCompactDate(char *out, int32_t jy, int32_t jm, int32_t jd) {
+        WriteTwoDigits(out, jy / 100);
+        WriteTwoDigits(out + 2, jy % 100);
+        WriteTwoDigits(out + 4, jm);
+        WriteTwoDigits(out + 6, jd);
+    }
+
+    // "HH:MM:SS"
+    static inline void WriteTime(char *out, int64_t micros) {
+        auto seconds = int32_t(micros / Interval::MICROS_PER_SEC);
+        WriteTwoDigits(out, seconds / 3600);
+        out[2] = ':';
+        WriteTwoDigits(out + 3, seconds / 60 % 60);
+        out[5] = ':';
+        WriteTwoDigits(out + 6, seconds % 60);
+    }
+
+    // ".ffffff"
+    static inline void WriteFraction(char *out, int64_t micros) {
+        auto fraction = int32_t(micros % Interval::MICROS_PER_SEC);
+        out[0] = '.';
+        for (idx_t i = 6; i > 0; i--) {
+            out[i] = char('0' + fraction % 10);
+            fraction /= 10;
+        }
+    }
+
+    static inline idx_t Length(JalaliOutputMode mode, int64_t micros) {
+        switch (mode) {
+        case JalaliOutputMode::AUTO:
+            return micros == 0 ? DATE_LENGTH : DATETIME_LENGTH;
+        case JalaliOutputMode::DATE:
+            return DATE_LENGTH;
+        case JalaliOutputMode::DATETIME:
+            return DATETIME_LENGTH;
+        case JalaliOutputMode::DATETIME_MICROS:
+            return DATETIME_MICROS_LENGTH;
+        default:
+            return COMPACT_LENGTH;
+        }
+    }
+
+    // Write a date and time of day in the given mode; returns the number of bytes written. Years outside
+    // 0..9999 take a slower snprintf path, so out must hold MAX_LENGTH bytes unless the year fits.
+    static inline idx_t Write(JalaliOutputMode mode, char *out, int32_t jy, int32_t jm, int32_t jd, int64_t micros) {
+        if (!YearFits(jy)) {
+            return WriteSlow(mode, out, jy, jm, jd, micros);
+        }
+        if (mode == JalaliOutputMode::COMPACT) {
+            WriteCompactDate(out, jy, jm, jd);
+            return COMPACT_LENGTH;
+        }
+        WriteDate(out, jy, jm, jd);
+        auto length = Length(mode, micros);
+        if (length > DATE_LENGTH) {
+            out[DATE_LENGTH] = ' ';
+            WriteTime(out + DATE_LENGTH + 1, micros);
+        }
+        if (length > DATETIME_LENGTH) {
+            WriteFraction(out + DATETIME_LENGTH, micros);
+        }
+        return length;
+    }
+
+    static idx_t WriteSlow(JalaliOutputMode mode, char *out, int32_t jy, int32_t jm, int32_t jd, int64_t micros) {
+        auto seconds = int32_t(micros / Interval::MICROS_PER_SEC);
+        auto fraction = int32_t(micros % Interval::MICROS_PER_SEC);
+        int written;
+        switch (Length(mode, micros)) {
+        case DATE_LENGTH:
+            written = snprintf(out, MAX_LENGTH, "%04d-%02d-%02d", jy, jm, jd);
+            break;
+        case DATETIME_LENGTH:
+            written = snprintf(out, MAX_LENGTH, "%04d-%02d-%02d %02d:%02d:%02d", jy, jm, jd, seconds / 3600,
+                               seconds / 60 % 60, seconds % 60);
+            break;
+        case DATETIME_MICROS_LENGTH:
+            written = snprintf(out, MAX_LENGTH, "%04d-%02d-%02d %02d:%02d:%02d.%06d", jy, jm, jd, seconds / 3600,
+                               seconds / 60 % 60, seconds % 60, fraction);
+            break;
+        default:
+            written = snprintf(out, MAX_LENGTH, "%04d%02d%02d", jy, jm, jd);
+            break;
+        }
+        return idx_t(written);
+    }
+};
+
+// Transcodes between ASCII digits and the two-byte UTF-8 Persian digits (U+06F0..U+06F9, 0xDB 0xB0..0xB9).
+// Arabic-Indic digits (U+0660..U+0669, 0xD9 0xA0..0xA9) are read as well. Callers size the output from the
+// counts first and then transcode straight into it; the counting loops are branch-free and auto-vectorize.
+struct JalaliDigits {
+    static constexpr uint8_t PERSIAN_LEAD = 0xDB;
+    static constexpr uint8_t PERSIAN_ZERO = 0xB0;
+    static constexpr uint8_t ARABIC_LEAD = 0xD9;
+    static constexpr uint8_t ARABIC_ZERO = 0xA0;
+
+    static inline idx_t CountAscii(const char *data, idx_t len) {
+        idx_t count = 0;
+        for (idx_t i = 0; i < len; i++) {
+            count += uint8_t(data[i] - '0') < 10;
+        }
+        return count;
+    }
+
+    // Value of the two-byte digit starting at data[i], or -1; continuation bytes never match a lead byte, so
+    // scanning byte by byte stays aligned with the code points
+    static inline int32_t NativeDigit(const char *data, idx_t len, idx_t i) {
+        if (i + 1 >= len) {
+            return -1;
+        }
+        auto lead = uint8_t(data[i]);
+        auto next = uint8_t(data[i + 1]);
+        if (lead == PERSIAN_LEAD && uint8_t(next - PERSIAN_ZERO) < 10) {
+            return next - PERSIAN_ZERO;
+        }
+        if (lead == ARABIC_LEAD && uint8_t(next - ARABIC_ZERO) < 10) {
+            return next - ARABIC_ZERO;
+        }
+        return -1;
+    }
+
+    static inline idx_t CountNative(const char *data, idx_t len) {
+        idx_t count = 0;
+        for (idx_t i = 0; i + 1 < len; i++) {
+            auto lead = uint8_t(data[i]);
+            auto next = uint8_t(data[i + 1]);
+            count += (lead == PERSIAN_LEAD && uint8_t(next - PERSIAN_ZERO) < 10) |
+                     (lead == ARABIC_LEAD && uint8_t(next - ARABIC_ZERO) < 10);
+        }
+        return count;
+    }
+
+    // Writes len + CountAscii(data, len) bytes
+    static inline void ToPersian(const char *data, idx_t len, char *out) {
+        for (idx_t i = 0; i < len; i++) {
+            auto digit = uint8_t(data[i] - '0');
+            if (digit < 10) {
+                *out++ = char(PERSIAN_LEAD);
+                *out++ = char(PERSIAN_ZERO + digit);
+            } else {
+                *out++ = data[i];
+            }
+        }
+    }
+
+    // Writes len - CountNative(data, len) bytes
+    static inline void ToAscii(const char *data, idx_t len, char *out) {
+        for (idx_t i = 0; i < len; i++) {
+            auto digit = NativeDigit(data, len, i);
+            if (digit >= 0) {
+                *out++ = char('0' + digit);
+                i++;
+            } else {
+                *out++ = data[i];
+            }
+        }
+    }
+};
+
+} // namespace duckdb
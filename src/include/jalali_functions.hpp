@@ -0,0 +1,54 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/storage/statistics/base_statistics.hpp"
+
+namespace duckdb {
+
+// Bind data holding a constant period argument
+struct JalaliPeriodBindData : public FunctionData {
+    explicit JalaliPeriodBindData(JalaliPeriod period) : period(period) {
+    }
+
+    JalaliPeriod period;
+
+    unique_ptr<FunctionData> Copy() const override {
+        return make_uniq<JalaliPeriodBindData>(period);
+    }
+
+    bool Equals(const FunctionData &other_p) const override {
+        return period == other_p.Cast<JalaliPeriodBindData>().period;
+    }
+};
+
+// Registration entry points for the functions that live outside jalali_extension.cpp
+struct JalaliFunctions {
+    static void RegisterPeriodFunctions(DatabaseInstance &instance);
+    static void RegisterSeriesFunctions(DatabaseInstance &instance);
+    static void RegisterFiscalFunctions(DatabaseInstance &instance);
+    static void RegisterArithmeticFunctions(DatabaseInstance &instance);
+    static void RegisterHistogramFunctions(DatabaseInstance &instance);
+    static void RegisterActivityFunctions(DatabaseInstance &instance);
+    static void RegisterMonthFunctions(DatabaseInstance &instance);
+    static void RegisterBusinessFunctions(DatabaseInstance &instance);
+    static void RegisterLiteralTypes(DatabaseInstance &instance);
+    static void RegisterStatsFunctions(DatabaseInstance &instance);
+    static void RegisterExtractFunctions(DatabaseInstance &instance);
+
+    // Evaluate an argument that has to be a non-NULL constant at bind time
+    static Value ConstantArgument(ClientContext &context, const string &function_name, Expression &argument);
+    static string ConstantStringArgument(ClientContext &context, const string &function_name, Expression &argument);
+    // Bind callback for scalar functions whose second argument is a constant period name: resolves it into
+    // JalaliPeriodBindData and removes it from the call
+    static unique_ptr<FunctionData> BindPeriodArgument(ClientContext &context, ScalarFunction &bound_function,
+                                                       vector<unique_ptr<Expression>> &arguments);
+
+    // Day numbers of the finite min/max of TIMESTAMP statistics, for the functions' statistics callbacks
+    static bool TimestampDayRange(const BaseStatistics &stats, int32_t &min_days, int32_t &max_days);
+
+    // The JALALI_MONTH logical type, see jalali_month.cpp
+    static LogicalType JalaliMonthType();
+};
+
+} // namespace duckdb
@@ -0,0 +1,444 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstring>
+#include <map>
+
+namespace duckdb {
+
+// Activity bitmaps: the set of days (day numbers) on which a key was active, stored roaring-style as a BLOB.
+// Days are split into containers of 4096 consecutive days. A container with fewer than ARRAY_LIMIT days is stored
+// as a sorted array of 16-bit offsets, a denser one as a 4096-bit bitmap.
+//
+// Layout: version (uint8), container count (uint32), then per container in ascending key order:
+// key (int32, day >> 12), cardinality (uint16, days - 1), kind (uint8), payload (offsets or 64 x uint64).
+struct JalaliActivityBitmap {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr int32_t CONTAINER_SHIFT = 12;
+    static constexpr idx_t CONTAINER_DAYS = 4096;
+    static constexpr idx_t WORDS = CONTAINER_DAYS / 64;
+    static constexpr idx_t ARRAY_LIMIT = 256;
+    static constexpr uint8_t KIND_ARRAY = 0;
+    static constexpr uint8_t KIND_BITMAP = 1;
+    static constexpr idx_t HEADER_SIZE = 5;
+    static constexpr idx_t CONTAINER_HEADER_SIZE = 7;
+
+    using Words = std::array<uint64_t, WORDS>;
+
+    static inline int32_t ContainerKey(int32_t day) {
+        return JalaliCalendar::FloorDiv(day, int32_t(CONTAINER_DAYS));
+    }
+
+    static inline idx_t Popcount(const Words &words) {
+        idx_t count = 0;
+        for (auto word : words) {
+            count += std::bitset<64>(word).count();
+        }
+        return count;
+    }
+
+    static string Serialize(const std::map<int32_t, Words> &containers) {
+        string result;
+        result.push_back(char(VERSION));
+        AppendValue<uint32_t>(result, uint32_t(containers.size()));
+        for (auto &entry : containers) {
+            auto &words = entry.second;
+            auto cardinality = Popcount(words);
+            AppendValue<int32_t>(result, entry.first);
+            AppendValue<uint16_t>(result, uint16_t(cardinality - 1));
+            if (cardinality < ARRAY_LIMIT) {
+                result.push_back(char(KIND_ARRAY));
+                for (idx_t w = 0; w < WORDS; w++) {
+                    for (auto word = words[w]; word != 0; word &= word - 1) {
+                        AppendValue<uint16_t>(result, uint16_t(w * 64 + std::bitset<64>((word & -word) - 1).count()));
+                    }
+                }
+            } else {
+                result.push_back(char(KIND_BITMAP));
+                for (auto word : words) {
+                    AppendValue<uint64_t>(result, word);
+                }
+            }
+        }
+        return result;
+    }
+
+    template <class T>
+    static void AppendValue(string &target, T value) {
+        char buffer[sizeof(T)];
+        memcpy(buffer, &value, sizeof(T));
+        target.append(buffer, sizeof(T));
+    }
+};
+
+// Sequential reader over the containers of a serialized bitmap
+class JalaliActivityReader {
+public:
+    explicit JalaliActivityReader(const string_t &blob)
+        : data(const_data_ptr_cast(blob.GetData())), size(blob.GetSize()), position(0), remaining(0) {
+        if (size < JalaliActivityBitmap::HEADER_SIZE || data[0] != JalaliActivityBitmap::VERSION) {
+            Corrupt();
+        }
+        remaining = ReadValue<uint32_t>(1);
+        position = JalaliActivityBitmap::HEADER_SIZE;
+    }
+
+    // Advance to the next container; returns false after the last one
+    bool Next() {
+        if (remaining == 0) {
+            if (position != size) {
+                Corrupt();
+            }
+            return false;
+        }
+        remaining--;
+        if (position + JalaliActivityBitmap::CONTAINER_HEADER_SIZE > size) {
+            Corrupt();
+        }
+        auto previous_key = key;
+        key = ReadValue<int32_t>(position);
+        if ((has_key && key <= previous_key) || key < MIN_KEY || key > MAX_KEY) {
+            Corrupt();
+        }
+        has_key = true;
+        cardinality = idx_t(ReadValue<uint16_t>(position + 4)) + 1;
+        kind = data[position + 6];
+        payload = position + JalaliActivityBitmap::CONTAINER_HEADER_SIZE;
+        idx_t payload_size;
+        if (kind == JalaliActivityBitmap::KIND_ARRAY) {
+            payload_size = cardinality * sizeof(uint16_t);
+        } else if (kind == JalaliActivityBitmap::KIND_BITMAP) {
+            payload_size = JalaliActivityBitmap::WORDS * sizeof(uint64_t);
+        } else {
+            Corrupt();
+        }
+        position = payload + payload_size;
+        if (position > size) {
+            Corrupt();
+        }
+        ValidatePayload();
+        return true;
+    }
+
+    // Expand the current container into a bitmap
+    void LoadWords(JalaliActivityBitmap::Words &words) const {
+        if (kind == JalaliActivityBitmap::KIND_BITMAP) {
+            for (idx_t w = 0; w < JalaliActivityBitmap::WORDS; w++) {
+                words[w] = ReadValue<uint64_t>(payload + w * sizeof(uint64_t));
+            }
+            return;
+        }
+        words.fill(0);
+        for (idx_t i = 0; i < cardinality; i++) {
+            auto offset = ReadValue<uint16_t>(payload + i * sizeof(uint16_t));
+            words[offset / 64] |= uint64_t(1) << (offset % 64);
+        }
+    }
+
+    [[noreturn]] static void Corrupt() {
+        throw InvalidInputException("Invalid Jalali activity bitmap");
+    }
+
+    int32_t key = 0;
+    idx_t cardinality = 0;
+
+private:
+    // Keys whose days all fit in an int32 day number
+    static constexpr int32_t MIN_KEY = NumericLimits<int32_t>::Minimum() >> JalaliActivityBitmap::CONTAINER_SHIFT;
+    static constexpr int32_t MAX_KEY = NumericLimits<int32_t>::Maximum() >> JalaliActivityBitmap::CONTAINER_SHIFT;
+
+    // The stored cardinality must match the payload, and the kind must be the one Serialize picks for it
+    void ValidatePayload() const {
+        if (kind == JalaliActivityBitmap::KIND_ARRAY) {
+            if (cardinality >= JalaliActivityBitmap::ARRAY_LIMIT) {
+                Corrupt();
+            }
+            idx_t previous = 0;
+            for (idx_t i = 0; i < cardinality; i++) {
+                idx_t offset = ReadValue<uint16_t>(payload + i * sizeof(uint16_t));
+                if (offset >= JalaliActivityBitmap::CONTAINER_DAYS || (i > 0 && offset <= previous)) {
+                    Corrupt();
+                }
+                previous = offset;
+            }
+            return;
+        }
+        if (cardinality < JalaliActivityBitmap::ARRAY_LIMIT) {
+            Corrupt();
+        }
+        JalaliActivityBitmap::Words words;
+        LoadWords(words);
+        if (JalaliActivityBitmap::Popcount(words) != cardinality) {
+            Corrupt();
+        }
+    }
+
+    template <class T>
+    T ReadValue(idx_t offset) const {
+        T value;
+        memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    const_data_ptr_t data;
+    idx_t size;
+    idx_t position;
+    uint32_t remaining;
+    uint8_t kind = 0;
+    idx_t payload = 0;
+    bool has_key = false;
+};
+
+//===--------------------------------------------------------------------===//
+// jalali_activity aggregate
+//===--------------------------------------------------------------------===//
+struct JalaliActivityState {
+    std::map<int32_t, JalaliActivityBitmap::Words> *containers;
+};
+
+struct JalaliActivityOperation {
+    template <class STATE>
+    static void Initialize(STATE &state) {
+        state.containers = nullptr;
+    }
+
+    static inline void AddDay(JalaliActivityState &state, int32_t day) {
+        if (!state.containers) {
+            state.containers = new std::map<int32_t, JalaliActivityBitmap::Words>();
+        }
+        auto key = JalaliActivityBitmap::ContainerKey(day);
+        auto entry = state.containers->find(key);
+        if (entry == state.containers->end()) {
+            JalaliActivityBitmap::Words words;
+            words.fill(0);
+            entry = state.containers->emplace(key, words).first;
+        }
+        auto offset = idx_t(day - key * int32_t(JalaliActivityBitmap::CONTAINER_DAYS));
+        entry->second[offset / 64] |= uint64_t(1) << (offset % 64);
+    }
+
+    template <class INPUT_TYPE, class STATE, class OP>
+    static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &) {
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(input, days, micros);
+        AddDay(state, days);
+    }
+
+    template <class INPUT_TYPE, class STATE, class OP>
+    static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
+                                  idx_t count) {
+        Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
+    }
+
+    template <class STATE, class OP>
+    static void Combine(const STATE &source, STATE &target, AggregateInputData &) {
+        if (!source.containers) {
+            return;
+        }
+        if (!target.containers) {
+            target.containers = new std::map<int32_t, JalaliActivityBitmap::Words>(*source.containers);
+            return;
+        }
+        for (auto &entry : *source.containers) {
+            auto existing = target.containers->find(entry.first);
+            if (existing == target.containers->end()) {
+                target.containers->emplace(entry.first, entry.second);
+                continue;
+            }
+            for (idx_t w = 0; w < JalaliActivityBitmap::WORDS; w++) {
+                existing->second[w] |= entry.second[w];
+            }
+        }
+    }
+
+    template <class T, class STATE>
+    static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+        if (!state.containers) {
+            finalize_data.ReturnNull();
+            return;
+        }
+        target = StringVector::AddStringOrBlob(finalize_data.result,
+                                               JalaliActivityBitmap::Serialize(*state.containers));
+    }
+
+    template <class STATE>
+    static void Destroy(STATE &state, AggregateInputData &) {
+        delete state.containers;
+    }
+
+    static bool IgnoreNull() {
+        return true;
+    }
+};
+
+//===--------------------------------------------------------------------===//
+// Bitmap functions
+//===--------------------------------------------------------------------===//
+static void JalaliActivityCountFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    UnaryExecutor::Execute<string_t, int64_t>(args.data[0], result, args.size(), [&](string_t blob) {
+        JalaliActivityReader reader(blob);
+        int64_t count = 0;
+        while (reader.Next()) {
+            count += int64_t(reader.cardinality);
+        }
+        return count;
+    });
+}
+
+static void JalaliActivityFirstFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    UnaryExecutor::ExecuteWithNulls<string_t, date_t>(
+        args.data[0], result, args.size(), [&](string_t blob, ValidityMask &mask, idx_t idx) {
+            JalaliActivityReader reader(blob);
+            if (!reader.Next()) {
+                mask.SetInvalid(idx);
+                return date_t();
+            }
+            JalaliActivityBitmap::Words words;
+            reader.LoadWords(words);
+            idx_t w = 0;
+            while (w < JalaliActivityBitmap::WORDS && words[w] == 0) {
+                w++;
+            }
+            if (w == JalaliActivityBitmap::WORDS) {
+                JalaliActivityReader::Corrupt();
+            }
+            auto offset = w * 64 + std::bitset<64>((words[w] & -words[w]) - 1).count();
+            return date_t(reader.key * int32_t(JalaliActivityBitmap::CONTAINER_DAYS) + int32_t(offset));
+        });
+}
+
+static void JalaliActivityIntersectCountFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    BinaryExecutor::Execute<string_t, string_t, int64_t>(
+        args.data[0], args.data[1], result, args.size(), [&](string_t left_blob, string_t right_blob) {
+            JalaliActivityReader left(left_blob);
+            JalaliActivityReader right(right_blob);
+            JalaliActivityBitmap::Words left_words;
+            JalaliActivityBitmap::Words right_words;
+            int64_t count = 0;
+            bool left_valid = left.Next();
+            bool right_valid = right.Next();
+            while (left_valid && right_valid) {
+                if (left.key < right.key) {
+                    left_valid = left.Next();
+                } else if (right.key < left.key) {
+                    right_valid = right.Next();
+                } else {
+                    left.LoadWords(left_words);
+                    right.LoadWords(right_words);
+                    for (idx_t w = 0; w < JalaliActivityBitmap::WORDS; w++) {
+                        count += int64_t(std::bitset<64>(left_words[w] & right_words[w]).count());
+                    }
+                    left_valid = left.Next();
+                    right_valid = right.Next();
+                }
+            }
+            return count;
+        });
+}
+
+// jalali_retention(bitmap, part, periods): element k tells whether the key was active in the k-th Jalali period
+// after the period of its first active day, so element 0 is always true
+static void JalaliRetentionFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+    auto period = func_expr.bind_info->Cast<JalaliPeriodBindData>().period;
+    const idx_t count = args.size();
+
+    UnifiedVectorFormat bitmap_data;
+    UnifiedVectorFormat periods_data;
+    args.data[0].ToUnifiedFormat(count, bitmap_data);
+    args.data[1].ToUnifiedFormat(count, periods_data);
+    auto bitmaps = UnifiedVectorFormat::GetData<string_t>(bitmap_data);
+    auto period_counts = UnifiedVectorFormat::GetData<int32_t>(periods_data);
+
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    auto list_entries = FlatVector::GetData<list_entry_t>(result);
+    auto &result_validity = FlatVector::Validity(result);
+
+    idx_t total = 0;
+    for (idx_t i = 0; i < count; i++) {
+        auto periods_idx = periods_data.sel->get_index(i);
+        if (periods_data.validity.RowIsValid(periods_idx) && period_counts[periods_idx] > 0) {
+            total += idx_t(period_counts[periods_idx]);
+        }
+    }
+    ListVector::Reserve(result, total);
+    auto &child = ListVector::GetEntry(result);
+    auto flags = FlatVector::GetData<bool>(child);
+
+    idx_t position = 0;
+    JalaliActivityBitmap::Words words;
+    for (idx_t i = 0; i < count; i++) {
+        auto bitmap_idx = bitmap_data.sel->get_index(i);
+        auto periods_idx = periods_data.sel->get_index(i);
+        if (!bitmap_data.validity.RowIsValid(bitmap_idx) || !periods_data.validity.RowIsValid(periods_idx)) {
+            result_validity.SetInvalid(i);
+            continue;
+        }
+        auto periods = idx_t(MaxValue<int32_t>(period_counts[periods_idx], 0));
+        list_entries[i].offset = position;
+        list_entries[i].length = periods;
+        memset(flags + position, 0, periods * sizeof(bool));
+
+        JalaliActivityReader reader(bitmaps[bitmap_idx]);
+        bool has_first = false;
+        int32_t first_period = 0;
+        while (reader.Next()) {
+            reader.LoadWords(words);
+            auto container_start = reader.key * int32_t(JalaliActivityBitmap::CONTAINER_DAYS);
+            for (idx_t w = 0; w < JalaliActivityBitmap::WORDS; w++) {
+                for (auto word = words[w]; word != 0; word &= word - 1) {
+                    auto offset = w * 64 + std::bitset<64>((word & -word) - 1).count();
+                    auto day_period = JalaliCalendar::PeriodId(container_start + int32_t(offset), period);
+                    if (!has_first) {
+                        has_first = true;
+                        first_period = day_period;
+                    }
+                    auto k = idx_t(day_period - first_period);
+                    if (k < periods) {
+                        flags[position + k] = true;
+                    }
+                }
+            }
+        }
+        position += periods;
+    }
+    ListVector::SetListSize(result, position);
+    if (args.AllConstant()) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
+}
+
+void JalaliFunctions::RegisterActivityFunctions(DatabaseInstance &instance) {
+    auto activity_function =
+        AggregateFunction::UnaryAggregateDestructor<JalaliActivityState, timestamp_t, string_t,
+                                                    JalaliActivityOperation>(LogicalType::TIMESTAMP, LogicalType::BLOB);
+    activity_function.name = "jalali_activity";
+    ExtensionUtil::RegisterFunction(instance, activity_function);
+
+    ScalarFunction count_function("jalali_activity_count", {LogicalType::BLOB}, LogicalType::BIGINT,
+                                  JalaliActivityCountFun);
+    ExtensionUtil::RegisterFunction(instance, count_function);
+
+    ScalarFunction first_function("jalali_activity_first", {LogicalType::BLOB}, LogicalType::DATE,
+                                  JalaliActivityFirstFun);
+    ExtensionUtil::RegisterFunction(instance, first_function);
+
+    ScalarFunction intersect_function("jalali_activity_intersect_count", {LogicalType::BLOB, LogicalType::BLOB},
+                                      LogicalType::BIGINT, JalaliActivityIntersectCountFun);
+    ExtensionUtil::RegisterFunction(instance, intersect_function);
+
+    ScalarFunction retention_function("jalali_retention",
+                                      {LogicalType::BLOB, LogicalType::VARCHAR, LogicalType::INTEGER},
+                                      LogicalType::LIST(LogicalType::BOOLEAN), JalaliRetentionFun,
+                                      JalaliFunctions::BindPeriodArgument);
+    ExtensionUtil::RegisterFunction(instance, retention_function);
+}
+
+} // namespace duckdb
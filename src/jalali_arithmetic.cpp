@@ -0,0 +1,336 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/function/function_set.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+
+namespace duckdb {
+
+//===--------------------------------------------------------------------===//
+// jalali_age
+//===--------------------------------------------------------------------===//
+struct JalaliDateFields {
+    int32_t year;
+    int32_t month;
+    int32_t day;
+
+    static inline JalaliDateFields FromTimestamp(timestamp_t ts) {
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(ts, days, micros);
+        JalaliDateFields result;
+        JalaliCalendar::FromDays(days, result.year, result.month, result.day);
+        return result;
+    }
+
+    inline bool operator<(const JalaliDateFields &other) const {
+        if (year != other.year) {
+            return year < other.year;
+        }
+        if (month != other.month) {
+            return month < other.month;
+        }
+        return day < other.day;
+    }
+};
+
+// Years, months and days from start to end in Jalali terms. Like age(), a negative day difference borrows the
+// length of the start month, and an end before the start gives a negated result.
+static inline void JalaliAge(const JalaliDateFields &start, const JalaliDateFields &end, int32_t &years,
+                             int32_t &months, int32_t &days) {
+    if (end < start) {
+        JalaliAge(end, start, years, months, days);
+        years = -years;
+        months = -months;
+        days = -days;
+        return;
+    }
+    years = end.year - start.year;
+    months = end.month - start.month;
+    days = end.day - start.day;
+    if (days < 0) {
+        months--;
+        days += JalaliCalendar::MonthDays(start.year, start.month);
+    }
+    if (months < 0) {
+        years--;
+        months += 12;
+    }
+}
+
+static void JalaliAgeScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &start_vector = args.data[0];
+    auto &end_vector = args.data[1];
+
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
+
+    UnifiedVectorFormat start_data;
+    UnifiedVectorFormat end_data;
+    start_vector.ToUnifiedFormat(args.size(), start_data);
+    end_vector.ToUnifiedFormat(args.size(), end_data);
+    auto start_values = UnifiedVectorFormat::GetData<timestamp_t>(start_data);
+    auto end_values = UnifiedVectorFormat::GetData<timestamp_t>(end_data);
+
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    auto &entries = StructVector::GetEntries(result);
+    auto years = FlatVector::GetData<int32_t>(*entries[0]);
+    auto months = FlatVector::GetData<int32_t>(*entries[1]);
+    auto days = FlatVector::GetData<int32_t>(*entries[2]);
+
+    // A constant as-of date is converted once for the whole vector
+    const bool constant_end = end_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+    JalaliDateFields constant_end_fields {0, 0, 0};
+    if (constant_end && !ConstantVector::IsNull(end_vector)) {
+        constant_end_fields = JalaliDateFields::FromTimestamp(ConstantVector::GetData<timestamp_t>(end_vector)[0]);
+    }
+
+    for (idx_t i = 0; i < count; i++) {
+        auto start_idx = start_data.sel->get_index(i);
+        auto end_idx = end_data.sel->get_index(i);
+        if (!start_data.validity.RowIsValid(start_idx) || !end_data.validity.RowIsValid(end_idx)) {
+            FlatVector::SetNull(result, i, true);
+            continue;
+        }
+        auto start_fields = JalaliDateFields::FromTimestamp(start_values[start_idx]);
+        auto end_fields = constant_end ? constant_end_fields : JalaliDateFields::FromTimestamp(end_values[end_idx]);
+        JalaliAge(start_fields, end_fields, years[i], months[i], days[i]);
+    }
+
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
+}
+
+//===--------------------------------------------------------------------===//
+// jalali_add / jalali_sub
+//===--------------------------------------------------------------------===//
+// Add a number of Jalali months to a day number, clamping the day to the length of the target month. The month
+// count is 64-bit so that callers can scale an INTEGER count; false when the target year is out of range.
+static inline bool JalaliTryAddMonths(int32_t days, int64_t months, int32_t &result) {
+    int32_t jy, jm, jd;
+    JalaliCalendar::FromDays(days, jy, jm, jd);
+    auto month_index = int64_t(jy) * 12 + jm - 1 + months;
+    auto year = JalaliCalendar::FloorDiv(month_index, int64_t(12));
+    if (year < JalaliCalendar::MIN_YEAR || year > JalaliCalendar::MAX_YEAR) {
+        return false;
+    }
+    auto month = int32_t(month_index - year * 12 + 1);
+    auto month_days = JalaliCalendar::MonthDays(int32_t(year), month);
+    result = JalaliCalendar::ToDays(int32_t(year), month, jd > month_days ? month_days : jd);
+    return true;
+}
+
+static inline int32_t JalaliAddMonths(int32_t days, int64_t months) {
+    int32_t result;
+    if (!JalaliTryAddMonths(days, months, result)) {
+        throw OutOfRangeException("Jalali date out of range: day %d plus %lld months", days, months);
+    }
+    return result;
+}
+
+// Apply an interval with its months counted in Jalali months, then its days and micros; false when the result is
+// not a finite TIMESTAMP. Infinite timestamps stay infinite, as with + INTERVAL.
+static inline bool JalaliTryAddInterval(timestamp_t ts, const interval_t &interval, timestamp_t &result) {
+    if (!Timestamp::IsFinite(ts)) {
+        result = ts;
+        return true;
+    }
+    int32_t days;
+    int64_t micros;
+    JalaliCalendar::SplitTimestamp(ts, days, micros);
+    if (interval.months != 0 && !JalaliTryAddMonths(days, interval.months, days)) {
+        return false;
+    }
+    return TryAddOperator::Operation<int32_t, int32_t, int32_t>(days, interval.days, days) &&
+           TryAddOperator::Operation<int64_t, int64_t, int64_t>(micros, interval.micros, micros) &&
+           JalaliCalendar::TryMakeTimestamp(days, micros, result);
+}
+
+static inline timestamp_t JalaliAddInterval(timestamp_t ts, const interval_t &interval, const char *function_name) {
+    timestamp_t result;
+    if (!JalaliTryAddInterval(ts, interval, result)) {
+        throw OutOfRangeException("%s: result is out of range", function_name);
+    }
+    return result;
+}
+
+static inline interval_t JalaliNegateInterval(const interval_t &interval) {
+    if (interval.months == NumericLimits<int32_t>::Minimum() || interval.days == NumericLimits<int32_t>::Minimum() ||
+        interval.micros == NumericLimits<int64_t>::Minimum()) {
+        throw OutOfRangeException("jalali_sub: interval is out of range");
+    }
+    interval_t result;
+    result.months = -interval.months;
+    result.days = -interval.days;
+    result.micros = -interval.micros;
+    return result;
+}
+
+template <bool SUBTRACT>
+static void JalaliAddScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto function_name = SUBTRACT ? "jalali_sub" : "jalali_add";
+    auto &ts_vector = args.data[0];
+    auto &interval_vector = args.data[1];
+
+    if (interval_vector.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+        if (ConstantVector::IsNull(interval_vector)) {
+            result.SetVectorType(VectorType::CONSTANT_VECTOR);
+            ConstantVector::SetNull(result, true);
+            return;
+        }
+        auto interval = ConstantVector::GetData<interval_t>(interval_vector)[0];
+        if (SUBTRACT) {
+            interval = JalaliNegateInterval(interval);
+        }
+        // No calendar math needed when the interval is a fixed number of microseconds
+        int64_t offset;
+        if (interval.months == 0 &&
+            TryMultiplyOperator::Operation<int64_t, int64_t, int64_t>(interval.days, Interval::MICROS_PER_DAY,
+                                                                      offset) &&
+            TryAddOperator::Operation<int64_t, int64_t, int64_t>(offset, interval.micros, offset)) {
+            UnaryExecutor::Execute<timestamp_t, timestamp_t>(ts_vector, result, args.size(), [&](timestamp_t ts) {
+                timestamp_t shifted;
+                if (!Timestamp::IsFinite(ts)) {
+                    return ts;
+                }
+                if (!TryAddOperator::Operation<int64_t, int64_t, int64_t>(ts.value, offset, shifted.value) ||
+                    !Timestamp::IsFinite(shifted)) {
+                    throw OutOfRangeException("%s: result is out of range", function_name);
+                }
+                return shifted;
+            });
+        } else {
+            UnaryExecutor::Execute<timestamp_t, timestamp_t>(ts_vector, result, args.size(), [&](timestamp_t ts) {
+                return JalaliAddInterval(ts, interval, function_name);
+            });
+        }
+        return;
+    }
+
+    BinaryExecutor::Execute<timestamp_t, interval_t, timestamp_t>(
+        ts_vector, interval_vector, result, args.size(), [&](timestamp_t ts, interval_t interval) {
+            return JalaliAddInterval(ts, SUBTRACT ? JalaliNegateInterval(interval) : interval, function_name);
+        });
+}
+
+//===--------------------------------------------------------------------===//
+// jalali_shift / jalali_same_period_last_year
+//===--------------------------------------------------------------------===//
+// Move a day number by n Jalali periods, in 64-bit so that no count overflows. Months, quarters and years keep the
+// day of the month, clamped to the length of the target month, so Esfand 30 of a leap year lands on Esfand 29.
+// False when the result is out of range.
+static inline bool JalaliTryShiftDays(int32_t days, JalaliPeriod period, int32_t n, int32_t &result) {
+    int64_t shifted;
+    switch (period) {
+    case JalaliPeriod::DAY:
+        shifted = int64_t(days) + n;
+        break;
+    case JalaliPeriod::WEEK:
+        shifted = int64_t(days) + 7 * int64_t(n);
+        break;
+    case JalaliPeriod::MONTH:
+        return JalaliTryAddMonths(days, n, result);
+    case JalaliPeriod::QUARTER:
+        return JalaliTryAddMonths(days, 3 * int64_t(n), result);
+    default:
+        return JalaliTryAddMonths(days, 12 * int64_t(n), result);
+    }
+    if (shifted < NumericLimits<int32_t>::Minimum() || shifted > NumericLimits<int32_t>::Maximum()) {
+        return false;
+    }
+    result = int32_t(shifted);
+    return true;
+}
+
+// Infinite timestamps stay infinite, as with jalali_add
+static inline timestamp_t JalaliShiftTimestamp(timestamp_t ts, JalaliPeriod period, int32_t n,
+                                               const char *function_name) {
+    if (!Timestamp::IsFinite(ts)) {
+        return ts;
+    }
+    int32_t days;
+    int64_t micros;
+    JalaliCalendar::SplitTimestamp(ts, days, micros);
+    timestamp_t result;
+    if (!JalaliTryShiftDays(days, period, n, days) || !JalaliCalendar::TryMakeTimestamp(days, micros, result)) {
+        throw OutOfRangeException("%s: result is out of range", function_name);
+    }
+    return result;
+}
+
+static void JalaliShiftScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+    auto period = func_expr.bind_info->Cast<JalaliPeriodBindData>().period;
+    BinaryExecutor::Execute<timestamp_t, int32_t, timestamp_t>(
+        args.data[0], args.data[1], result, args.size(),
+        [&](timestamp_t ts, int32_t n) { return JalaliShiftTimestamp(ts, period, n, "jalali_shift"); });
+}
+
+// The same Jalali day one year earlier
+static void JalaliSamePeriodLastYearFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    UnaryExecutor::Execute<timestamp_t, timestamp_t>(args.data[0], result, args.size(), [&](timestamp_t ts) {
+        return JalaliShiftTimestamp(ts, JalaliPeriod::YEAR, -1, "jalali_same_period_last_year");
+    });
+}
+
+// Period id of the same period one year earlier, to equi-join against jalali_period_id of last year's rows.
+// Month, quarter and year ids are consecutive, so they shift by a constant; days and weeks go through the
+// clamped day one year earlier.
+static void JalaliSamePeriodLastYearKeyFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+    auto period = func_expr.bind_info->Cast<JalaliPeriodBindData>().period;
+    int32_t ids_per_year;
+    switch (period) {
+    case JalaliPeriod::MONTH:
+        ids_per_year = 12;
+        break;
+    case JalaliPeriod::QUARTER:
+        ids_per_year = 4;
+        break;
+    case JalaliPeriod::YEAR:
+        ids_per_year = 1;
+        break;
+    default:
+        ids_per_year = 0;
+        break;
+    }
+    UnaryExecutor::Execute<timestamp_t, int32_t>(args.data[0], result, args.size(), [&](timestamp_t ts) {
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(ts, days, micros);
+        if (ids_per_year != 0) {
+            return JalaliCalendar::PeriodId(days, period) - ids_per_year;
+        }
+        return JalaliCalendar::PeriodId(JalaliAddMonths(days, -12), period);
+    });
+}
+
+void JalaliFunctions::RegisterArithmeticFunctions(DatabaseInstance &instance) {
+    auto age_type = LogicalType::STRUCT(
+        {{"years", LogicalType::INTEGER}, {"months", LogicalType::INTEGER}, {"days", LogicalType::INTEGER}});
+    ScalarFunction age_function("jalali_age", {LogicalType::TIMESTAMP, LogicalType::TIMESTAMP}, age_type,
+                                JalaliAgeScalarFun);
+    ExtensionUtil::RegisterFunction(instance, age_function);
+
+    ScalarFunction add_function("jalali_add", {LogicalType::TIMESTAMP, LogicalType::INTERVAL}, LogicalType::TIMESTAMP,
+                                JalaliAddScalarFun<false>);
+    ExtensionUtil::RegisterFunction(instance, add_function);
+    ScalarFunction sub_function("jalali_sub", {LogicalType::TIMESTAMP, LogicalType::INTERVAL}, LogicalType::TIMESTAMP,
+                                JalaliAddScalarFun<true>);
+    ExtensionUtil::RegisterFunction(instance, sub_function);
+
+    ScalarFunction shift_function("jalali_shift", {LogicalType::TIMESTAMP, LogicalType::VARCHAR, LogicalType::INTEGER},
+                                  LogicalType::TIMESTAMP, JalaliShiftScalarFun, JalaliFunctions::BindPeriodArgument);
+    ExtensionUtil::RegisterFunction(instance, shift_function);
+
+    ScalarFunctionSet last_year_set("jalali_same_period_last_year");
+    last_year_set.AddFunction(
+        ScalarFunction({LogicalType::TIMESTAMP}, LogicalType::TIMESTAMP, JalaliSamePeriodLastYearFun));
+    last_year_set.AddFunction(ScalarFunction({LogicalType::TIMESTAMP, LogicalType::VARCHAR}, LogicalType::INTEGER,
+                                             JalaliSamePeriodLastYearKeyFun, JalaliFunctions::BindPeriodArgument));
+    ExtensionUtil::RegisterFunction(instance, last_year_set);
+}
+
+} // namespace duckdb
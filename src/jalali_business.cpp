@@ -0,0 +1,359 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/function_set.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace duckdb {
+
+// A weekly office schedule compiled into cumulative working minutes, plus holidays as a day bitmap with a prefix
+// sum of the working minutes they remove. W(t), the working time from the epoch up to t, is then a few lookups,
+// and business time between two timestamps is W(b) - W(a).
+struct JalaliBusinessSchedule {
+    static constexpr int32_t MINUTES_PER_DAY = 1440;
+    static constexpr int32_t MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+    static constexpr int64_t MICROS_PER_MINUTE = Interval::MICROS_PER_MINUTE;
+    static constexpr int32_t MAX_HOLIDAY_SPAN = 100000;
+    static constexpr int64_t MAX_SEARCH_DAYS = int64_t(1) << 26;
+
+    // Working minutes of the week before each minute; weeks start on Saturday 00:00, like Jalali weeks
+    int32_t week_cumulative[MINUTES_PER_WEEK + 1];
+    // Holidays on days first_holiday + i; holiday_loss[i] sums the working minutes of the holidays before that day
+    int32_t first_holiday = 0;
+    vector<bool> holidays;
+    vector<int64_t> holiday_loss;
+
+    static inline int32_t Weekday(int32_t days) {
+        auto since_saturday = int64_t(days) - JalaliCalendar::FIRST_SATURDAY;
+        return int32_t(since_saturday - JalaliCalendar::FloorDiv(since_saturday, int64_t(7)) * 7);
+    }
+
+    bool IsHoliday(int64_t days) const {
+        auto index = days - first_holiday;
+        return index >= 0 && index < int64_t(holidays.size()) && holidays[idx_t(index)];
+    }
+
+    int64_t HolidayLoss(int64_t days) const {
+        if (holiday_loss.empty() || days <= first_holiday) {
+            return 0;
+        }
+        auto index = MinValue<int64_t>(days - first_holiday, int64_t(holiday_loss.size()) - 1);
+        return holiday_loss[idx_t(index)];
+    }
+
+    // Working minutes before the start of a day
+    int64_t DayStart(int64_t days) const {
+        auto since_saturday = days - JalaliCalendar::FIRST_SATURDAY;
+        auto weeks = JalaliCalendar::FloorDiv(since_saturday, int64_t(7));
+        auto weekday = since_saturday - weeks * 7;
+        return weeks * week_cumulative[MINUTES_PER_WEEK] + week_cumulative[weekday * MINUTES_PER_DAY] -
+               HolidayLoss(days);
+    }
+
+    // W(t) in microseconds
+    int64_t WorkedMicros(timestamp_t ts) const {
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(ts, days, micros);
+        auto worked = DayStart(days) * MICROS_PER_MINUTE;
+        if (IsHoliday(days)) {
+            return worked;
+        }
+        auto base = Weekday(days) * MINUTES_PER_DAY;
+        auto minute = int32_t(micros / MICROS_PER_MINUTE);
+        worked += int64_t(week_cumulative[base + minute] - week_cumulative[base]) * MICROS_PER_MINUTE;
+        if (week_cumulative[base + minute + 1] > week_cumulative[base + minute]) {
+            worked += micros % MICROS_PER_MINUTE;
+        }
+        return worked;
+    }
+
+    // Smallest day e in (low, high] with DayStart(e) * MICROS_PER_MINUTE > target (or >= target when inclusive)
+    int64_t FindDay(int64_t low, int64_t high, int64_t target, bool inclusive) const {
+        while (high - low > 1) {
+            auto mid = low + (high - low) / 2;
+            auto start = DayStart(mid) * MICROS_PER_MINUTE;
+            if (inclusive ? start >= target : start > target) {
+                high = mid;
+            } else {
+                low = mid;
+            }
+        }
+        return high;
+    }
+
+    // Move by delta microseconds of working time. Moving forward ends at the earliest moment the work is done,
+    // moving backward at the latest moment it could have started.
+    timestamp_t AddMicros(timestamp_t ts, int64_t delta) const {
+        if (delta == 0) {
+            return ts;
+        }
+        int32_t start_day;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(ts, start_day, micros);
+        auto target = WorkedMicros(ts) + delta;
+        bool forward = delta > 0;
+
+        // Gallop to a day range containing the target, then binary search it
+        int64_t low = forward ? start_day : start_day + 1;
+        int64_t high = low;
+        for (int64_t step = 1;; step *= 2) {
+            if (step > MAX_SEARCH_DAYS) {
+                throw OutOfRangeException("jalali_add_business_hours: result is out of range");
+            }
+            if (forward) {
+                high = start_day + step;
+                if (DayStart(high) * MICROS_PER_MINUTE >= target) {
+                    break;
+                }
+                low = high;
+            } else {
+                low = start_day + 1 - step;
+                if (DayStart(low) * MICROS_PER_MINUTE <= target) {
+                    break;
+                }
+                high = low;
+            }
+        }
+        auto day = FindDay(low, high, target, forward) - 1;
+        auto remaining = target - DayStart(day) * MICROS_PER_MINUTE;
+
+        // Locate the working minute of the day that holds the remaining time
+        auto base = Weekday(int32_t(day)) * MINUTES_PER_DAY;
+        auto day_begin = week_cumulative + base + 1;
+        auto day_end = day_begin + MINUTES_PER_DAY;
+        const int32_t *entry;
+        if (forward) {
+            auto needed = (remaining + MICROS_PER_MINUTE - 1) / MICROS_PER_MINUTE;
+            entry = std::lower_bound(day_begin, day_end, week_cumulative[base] + int32_t(needed));
+        } else {
+            auto covered = remaining / MICROS_PER_MINUTE;
+            entry = std::upper_bound(day_begin, day_end, week_cumulative[base] + int32_t(covered));
+        }
+        auto minute = int32_t(entry - day_begin);
+        auto minute_start = int64_t(week_cumulative[base + minute] - week_cumulative[base]) * MICROS_PER_MINUTE;
+        auto day_micros = minute * MICROS_PER_MINUTE + remaining - minute_start;
+        return JalaliCalendar::MakeTimestamp(int32_t(day), day_micros);
+    }
+};
+
+static constexpr const char *JALALI_WEEKDAY_NAMES[] = {"sat", "sun", "mon", "tue", "wed", "thu", "fri"};
+
+// Iranian office hours: Saturday to Wednesday 08:00-16:00, Thursday 08:00-12:00, Friday off
+static constexpr const char *JALALI_IRAN_OFFICE_SCHEDULE = "sat-wed 08:00-16:00; thu 08:00-12:00";
+
+static int32_t JalaliParseWeekday(const string &name, const string &schedule) {
+    for (int32_t i = 0; i < 7; i++) {
+        if (name == JALALI_WEEKDAY_NAMES[i]) {
+            return i;
+        }
+    }
+    throw InvalidInputException("Invalid business schedule \"%s\": unknown weekday \"%s\"", schedule, name);
+}
+
+static int32_t JalaliParseClock(const string &text, const string &schedule) {
+    idx_t pos = 0;
+    int32_t hour, minute;
+    if (!JalaliParser::ParseNumber(text.c_str(), text.size(), pos, hour, 2) || pos >= text.size() ||
+        text[pos] != ':') {
+        throw InvalidInputException("Invalid business schedule \"%s\": bad time \"%s\"", schedule, text);
+    }
+    pos++;
+    if (!JalaliParser::ParseNumber(text.c_str(), text.size(), pos, minute, 2) || pos != text.size() || minute > 59 ||
+        hour * 60 + minute > JalaliBusinessSchedule::MINUTES_PER_DAY) {
+        throw InvalidInputException("Invalid business schedule \"%s\": bad time \"%s\"", schedule, text);
+    }
+    return hour * 60 + minute;
+}
+
+// Compile "sat-wed 08:00-16:00; thu 08:00-12:00": entries separated by ';' or ',', each a weekday or weekday
+// range followed by one or more HH:MM-HH:MM working intervals. "iran_office" names the schedule above.
+static shared_ptr<JalaliBusinessSchedule> JalaliCompileSchedule(const string &schedule_p, const Value &holidays) {
+    auto schedule = StringUtil::Lower(schedule_p);
+    StringUtil::Trim(schedule);
+    if (schedule == "iran_office") {
+        schedule = JALALI_IRAN_OFFICE_SCHEDULE;
+    }
+    bool working[JalaliBusinessSchedule::MINUTES_PER_WEEK] = {};
+    schedule = StringUtil::Replace(schedule, ",", ";");
+    for (auto &entry : StringUtil::Split(schedule, ';')) {
+        vector<string> tokens;
+        for (auto &token : StringUtil::Split(entry, ' ')) {
+            StringUtil::Trim(token);
+            if (!token.empty()) {
+                tokens.push_back(token);
+            }
+        }
+        if (tokens.empty()) {
+            continue;
+        }
+        if (tokens.size() < 2) {
+            throw InvalidInputException("Invalid business schedule \"%s\": expected working hours after \"%s\"",
+                                        schedule_p, tokens[0]);
+        }
+        auto day_range = StringUtil::Split(tokens[0], '-');
+        if (day_range.empty() || day_range.size() > 2) {
+            throw InvalidInputException("Invalid business schedule \"%s\": bad weekdays \"%s\"", schedule_p,
+                                        tokens[0]);
+        }
+        auto first_day = JalaliParseWeekday(day_range[0], schedule_p);
+        auto last_day = JalaliParseWeekday(day_range.back(), schedule_p);
+        for (idx_t t = 1; t < tokens.size(); t++) {
+            auto clock_range = StringUtil::Split(tokens[t], '-');
+            if (clock_range.size() != 2) {
+                throw InvalidInputException("Invalid business schedule \"%s\": bad hours \"%s\"", schedule_p,
+                                            tokens[t]);
+            }
+            auto begin = JalaliParseClock(clock_range[0], schedule_p);
+            auto end = JalaliParseClock(clock_range[1], schedule_p);
+            if (begin >= end) {
+                throw InvalidInputException("Invalid business schedule \"%s\": hours \"%s\" end before they start",
+                                            schedule_p, tokens[t]);
+            }
+            for (auto day = first_day;; day = (day + 1) % 7) {
+                for (auto minute = begin; minute < end; minute++) {
+                    working[day * JalaliBusinessSchedule::MINUTES_PER_DAY + minute] = true;
+                }
+                if (day == last_day) {
+                    break;
+                }
+            }
+        }
+    }
+
+    auto result = make_shared_ptr<JalaliBusinessSchedule>();
+    result->week_cumulative[0] = 0;
+    for (int32_t m = 0; m < JalaliBusinessSchedule::MINUTES_PER_WEEK; m++) {
+        result->week_cumulative[m + 1] = result->week_cumulative[m] + working[m];
+    }
+    if (result->week_cumulative[JalaliBusinessSchedule::MINUTES_PER_WEEK] == 0) {
+        throw InvalidInputException("Invalid business schedule \"%s\": no working hours", schedule_p);
+    }
+
+    if (holidays.IsNull()) {
+        return result;
+    }
+    vector<int32_t> days;
+    for (auto &holiday : ListValue::GetChildren(holidays)) {
+        if (!holiday.IsNull()) {
+            auto date = holiday.GetValue<date_t>();
+            if (!Date::IsFinite(date)) {
+                throw InvalidInputException("Holidays must be finite dates");
+            }
+            days.push_back(date.days);
+        }
+    }
+    if (days.empty()) {
+        return result;
+    }
+    std::sort(days.begin(), days.end());
+    auto span = int64_t(days.back()) - days.front() + 1;
+    if (span > JalaliBusinessSchedule::MAX_HOLIDAY_SPAN) {
+        throw InvalidInputException("Holidays may span at most %d days", JalaliBusinessSchedule::MAX_HOLIDAY_SPAN);
+    }
+    result->first_holiday = days.front();
+    result->holidays.resize(idx_t(span), false);
+    for (auto day : days) {
+        result->holidays[idx_t(day - days.front())] = true;
+    }
+    result->holiday_loss.resize(idx_t(span) + 1, 0);
+    for (idx_t i = 0; i < idx_t(span); i++) {
+        int64_t lost = 0;
+        if (result->holidays[i]) {
+            auto base = JalaliBusinessSchedule::Weekday(result->first_holiday + int32_t(i)) *
+                        JalaliBusinessSchedule::MINUTES_PER_DAY;
+            lost = result->week_cumulative[base + JalaliBusinessSchedule::MINUTES_PER_DAY] -
+                   result->week_cumulative[base];
+        }
+        result->holiday_loss[i + 1] = result->holiday_loss[i] + lost;
+    }
+    return result;
+}
+
+struct JalaliScheduleBindData : public FunctionData {
+    JalaliScheduleBindData(shared_ptr<JalaliBusinessSchedule> schedule, string description)
+        : schedule(std::move(schedule)), description(std::move(description)) {
+    }
+
+    shared_ptr<JalaliBusinessSchedule> schedule;
+    string description;
+
+    unique_ptr<FunctionData> Copy() const override {
+        return make_uniq<JalaliScheduleBindData>(schedule, description);
+    }
+
+    bool Equals(const FunctionData &other_p) const override {
+        return description == other_p.Cast<JalaliScheduleBindData>().description;
+    }
+};
+
+// Compile the constant schedule (argument 2) and optional holidays (argument 3) and remove them from the call
+static unique_ptr<FunctionData> JalaliScheduleBind(ClientContext &context, ScalarFunction &bound_function,
+                                                   vector<unique_ptr<Expression>> &arguments) {
+    auto schedule = JalaliFunctions::ConstantStringArgument(context, bound_function.name, *arguments[2]);
+    Value holidays(LogicalType::LIST(LogicalType::DATE));
+    if (arguments.size() > 3) {
+        auto &argument = *arguments[3];
+        if (argument.HasParameter() || !argument.IsFoldable()) {
+            throw BinderException("%s: the holidays argument must be a constant", bound_function.name);
+        }
+        holidays = ExpressionExecutor::EvaluateScalar(context, argument);
+        Function::EraseArgument(bound_function, arguments, 3);
+    }
+    Function::EraseArgument(bound_function, arguments, 2);
+    auto compiled = JalaliCompileSchedule(schedule, holidays);
+    return make_uniq<JalaliScheduleBindData>(std::move(compiled), schedule + "|" + holidays.ToString());
+}
+
+static void JalaliBusinessHoursBetweenFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+    auto &schedule = *func_expr.bind_info->Cast<JalaliScheduleBindData>().schedule;
+    BinaryExecutor::Execute<timestamp_t, timestamp_t, double>(
+        args.data[0], args.data[1], result, args.size(), [&](timestamp_t start, timestamp_t end) {
+            if (!Value::IsFinite(start) || !Value::IsFinite(end)) {
+                throw OutOfRangeException("jalali_business_hours_between: timestamps must be finite");
+            }
+            auto worked = schedule.WorkedMicros(end) - schedule.WorkedMicros(start);
+            return double(worked) / double(Interval::MICROS_PER_HOUR);
+        });
+}
+
+static void JalaliAddBusinessHoursFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+    auto &schedule = *func_expr.bind_info->Cast<JalaliScheduleBindData>().schedule;
+    BinaryExecutor::Execute<timestamp_t, double, timestamp_t>(
+        args.data[0], args.data[1], result, args.size(), [&](timestamp_t ts, double hours) {
+            if (!Value::IsFinite(ts) || !std::isfinite(hours) || std::fabs(hours) > 1e9) {
+                throw OutOfRangeException("jalali_add_business_hours: result is out of range");
+            }
+            return schedule.AddMicros(ts, int64_t(std::llround(hours * double(Interval::MICROS_PER_HOUR))));
+        });
+}
+
+void JalaliFunctions::RegisterBusinessFunctions(DatabaseInstance &instance) {
+    auto holidays_type = LogicalType::LIST(LogicalType::DATE);
+
+    ScalarFunctionSet between_set("jalali_business_hours_between");
+    between_set.AddFunction(ScalarFunction({LogicalType::TIMESTAMP, LogicalType::TIMESTAMP, LogicalType::VARCHAR},
+                                           LogicalType::DOUBLE, JalaliBusinessHoursBetweenFun, JalaliScheduleBind));
+    between_set.AddFunction(
+        ScalarFunction({LogicalType::TIMESTAMP, LogicalType::TIMESTAMP, LogicalType::VARCHAR, holidays_type},
+                       LogicalType::DOUBLE, JalaliBusinessHoursBetweenFun, JalaliScheduleBind));
+    ExtensionUtil::RegisterFunction(instance, between_set);
+
+    ScalarFunctionSet add_set("jalali_add_business_hours");
+    add_set.AddFunction(ScalarFunction({LogicalType::TIMESTAMP, LogicalType::DOUBLE, LogicalType::VARCHAR},
+                                       LogicalType::TIMESTAMP, JalaliAddBusinessHoursFun, JalaliScheduleBind));
+    add_set.AddFunction(
+        ScalarFunction({LogicalType::TIMESTAMP, LogicalType::DOUBLE, LogicalType::VARCHAR, holidays_type},
+                       LogicalType::TIMESTAMP, JalaliAddBusinessHoursFun, JalaliScheduleBind));
+    ExtensionUtil::RegisterFunction(instance, add_set);
+}
+
+} // namespace duckdb
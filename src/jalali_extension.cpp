@@ -1,11 +1,17 @@
 #define DUCKDB_EXTENSION_MAIN
 
 #include "jalali_extension.hpp"
+#include "jalali_adaptive.hpp"
+#include "jalali_calendar.hpp"
+#include "jalali_functions.hpp"
 #include "duckdb.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/string_util.hpp"
+#include "duckdb/execution/expression_executor_state.hpp"
+#include "duckdb/function/function_set.hpp"
 #include "duckdb/function/scalar_function.hpp"
 #include "duckdb/main/extension_util.hpp"
+#include "duckdb/storage/statistics/string_stats.hpp"
 #include <duckdb/parser/parsed_data/create_scalar_function_info.hpp>
 #include <duckdb/common/types/timestamp.hpp>
 #include <duckdb/common/types/date.hpp>
@@ -18,214 +24,624 @@ bool IsLeapYear(int year) {
     return (year % 400 == 0) || ((year % 100 != 0) && (year % 4 == 0));
 }
 
-// Helper function to convert Jalali date to Gregorian date with optional time component
-duckdb::timestamp_t JalaliToGregorian(string_t jalali_datetime, bool end_of_day) {
-    // Split the input into date and time components
-    string datetime_str = jalali_datetime.GetString();
-    auto datetime_parts = StringUtil::Split(datetime_str, ' '); // Split into date and time parts
+// Scratch columns for the staged conversion pipeline. Each stage reads and writes whole columns so that
+// the calendar math runs as tight loops over plain arrays, one instance per executing thread.
+struct JalaliLocalState : public FunctionLocalState {
+    int32_t year[STANDARD_VECTOR_SIZE];
+    int32_t month[STANDARD_VECTOR_SIZE];
+    int32_t day[STANDARD_VECTOR_SIZE];
+    int32_t days[STANDARD_VECTOR_SIZE];
+    int64_t micros[STANDARD_VECTOR_SIZE];
+    // Chooses how stage 2 of the Gregorian to Jalali pipeline turns day numbers into date fields
+    JalaliAdaptiveFromDays from_days;
+};
+
+static unique_ptr<FunctionLocalState> JalaliInitLocalState(ExpressionState &state, const BoundFunctionExpression &expr,
+                                                           FunctionData *bind_data) {
+    auto result = make_uniq<JalaliLocalState>();
+    result->from_days.Initialize(JalaliStats::Get(state.GetContext()));
+    return std::move(result);
+}
 
-    // Parse the date part
-    auto date_part = datetime_parts[0];
-    auto date_parts = StringUtil::Split(date_part, '-');
-    if (date_parts.size() != 3) {
-        throw InvalidInputException("Invalid Jalali date format. Expected format: YYYY-MM-DD");
-    }
-    int jy = stoi(date_parts[0]);
-    int jm = stoi(date_parts[1]);
-    int jd = stoi(date_parts[2]);
-
-    jy -= 979;
-    int j_day_no = 365 * jy + (jy / 33) * 8 + ((jy % 33 + 3) / 4);
-    for (int i = 1; i < jm; ++i) {
-        if (i <= 6) {
-            j_day_no += 31;
+// Convert rows [offset, offset + count) of a Jalali text column into timestamps, count <= STANDARD_VECTOR_SIZE
+static void JalaliToGregorianBatch(JalaliLocalState &lstate, const UnifiedVectorFormat &jalali_data,
+                                   const UnifiedVectorFormat &end_of_day_data, idx_t offset, idx_t count,
+                                   timestamp_t *result_data, ValidityMask &result_validity) {
+    auto jalali_values = UnifiedVectorFormat::GetData<string_t>(jalali_data);
+    auto end_of_day_values = UnifiedVectorFormat::GetData<bool>(end_of_day_data);
+
+    // Stage 1: parse the text into date fields and a time of day
+    JalaliParts parts;
+    for (idx_t i = 0; i < count; i++) {
+        auto jalali_idx = jalali_data.sel->get_index(offset + i);
+        auto end_of_day_idx = end_of_day_data.sel->get_index(offset + i);
+        if (!jalali_data.validity.RowIsValid(jalali_idx) || !end_of_day_data.validity.RowIsValid(end_of_day_idx)) {
+            result_validity.SetInvalid(offset + i);
+            parts = JalaliParts();
         } else {
-            j_day_no += 30;
+            JalaliParser::Parse(jalali_values[jalali_idx], parts);
         }
+        lstate.year[i] = parts.year;
+        lstate.month[i] = parts.month;
+        lstate.day[i] = parts.day;
+        // Times with a UTC offset are normalized to UTC
+        auto local_micros = end_of_day_values[end_of_day_idx] ? JalaliCalendar::END_OF_DAY_MICROS : parts.micros;
+        lstate.micros[i] = local_micros - parts.offset_micros;
     }
-    j_day_no += jd - 1;
-
-    int g_day_no = j_day_no + 79;
-
-    int gy = 1600 + 400 * (g_day_no / 146097);
-    g_day_no %= 146097;
-    bool leap = true;
-    if (g_day_no >= 36525) {
-        g_day_no--;
-        gy += 100 * (g_day_no / 36524);
-        g_day_no %= 36524;
-        if (g_day_no >= 365) {
-            g_day_no++;
-        } else {
-            leap = false;
+
+    // Stage 2: date fields to day numbers
+    JalaliCalendar::ToDays(lstate.year, lstate.month, lstate.day, lstate.days, count);
+
+    // Stage 3: day numbers and time of day to timestamps
+    for (idx_t i = 0; i < count; i++) {
+        if (!JalaliCalendar::TryMakeTimestamp(lstate.days[i], lstate.micros[i], result_data[offset + i])) {
+            throw InvalidInputException("Jalali date out of range: day %d is outside the TIMESTAMP range",
+                                        lstate.days[i]);
         }
     }
+}
 
-    gy += 4 * (g_day_no / 1461);
-    g_day_no %= 1461;
-    if (g_day_no >= 366) {
-        gy += (g_day_no - 1) / 365;
-        g_day_no = (g_day_no - 1) % 365;
-        leap = false;
+// Stages 2 and 3 of the Gregorian to Jalali pipeline: turn the day numbers and times of day in lstate into Jalali
+// text for rows [offset, offset + count) of result. Rows that are NULL in gregorian_data become NULL.
+// One kernel is instantiated per output mode so that the fixed-width modes format without a per-row width decision.
+// PERSIAN kernels format into a stack buffer and transcode its digits straight into the presized result.
+template <JalaliOutputMode MODE, bool PERSIAN = false>
+static void JalaliFormatBatch(JalaliLocalState &lstate, const UnifiedVectorFormat &gregorian_data, idx_t offset,
+                              idx_t count, Vector &result) {
+    auto result_data = FlatVector::GetData<string_t>(result);
+    auto &result_validity = FlatVector::Validity(result);
+
+    // Stage 2: day numbers to Jalali date fields, with the strategy that is fastest on this data
+    lstate.from_days.FromDays(lstate.days, lstate.year, lstate.month, lstate.day, count);
+
+    // Stage 3: format
+    for (idx_t i = 0; i < count; i++) {
+        auto idx = gregorian_data.sel->get_index(offset + i);
+        auto &target = result_data[offset + i];
+        if (!gregorian_data.validity.RowIsValid(idx)) {
+            result_validity.SetInvalid(offset + i);
+            continue;
+        }
+        if (PERSIAN) {
+            char buffer[JalaliFormatter::MAX_LENGTH];
+            auto length = JalaliFormatter::Write(MODE, buffer, lstate.year[i], lstate.month[i], lstate.day[i],
+                                                 lstate.micros[i]);
+            target = StringVector::EmptyString(result, length + JalaliDigits::CountAscii(buffer, length));
+            JalaliDigits::ToPersian(buffer, length, target.GetDataWriteable());
+            target.Finalize();
+            continue;
+        }
+        if (!JalaliFormatter::YearFits(lstate.year[i])) {
+            char buffer[JalaliFormatter::MAX_LENGTH];
+            auto length = JalaliFormatter::WriteSlow(MODE, buffer, lstate.year[i], lstate.month[i], lstate.day[i],
+                                                     lstate.micros[i]);
+            target = StringVector::AddString(result, buffer, length);
+            continue;
+        }
+        target = StringVector::EmptyString(result, JalaliFormatter::Length(MODE, lstate.micros[i]));
+        JalaliFormatter::Write(MODE, target.GetDataWriteable(), lstate.year[i], lstate.month[i], lstate.day[i],
+                               lstate.micros[i]);
+        target.Finalize();
     }
+}
 
-    int gm = 1;
-    while (true) {
-        int month_days;
-        if (gm == 2) {
-            month_days = leap ? 29 : 28;
-        } else if (gm <= 7 && gm % 2 == 1) {
-            month_days = 31;
-        } else if (gm >= 8 && gm % 2 == 0) {
-            month_days = 31;
-        } else {
-            month_days = 30;
-        }
+static inline void SplitGregorian(timestamp_t ts, int32_t &days, int64_t &micros) {
+    JalaliCalendar::SplitTimestamp(ts, days, micros);
+}
 
-        if (g_day_no < month_days) {
-            break;
-        }
-        g_day_no -= month_days;
-        gm++;
+// Dates reach the calendar stages as day numbers, so infinities and dates past the TIMESTAMP range are rejected here
+static inline void SplitGregorian(date_t date, int32_t &days, int64_t &micros) {
+    timestamp_t ts;
+    if (!JalaliCalendar::TryMakeTimestamp(date.days, 0, ts)) {
+        throw InvalidInputException("Gregorian date out of range: \"%s\" is outside the TIMESTAMP range",
+                                    Date::ToString(date));
     }
-    int gd = g_day_no + 1;
-
-    // Time component (default to 00:00:00 if not provided)
-    int hour = 0, minute = 0, second = 0;
-    if (datetime_parts.size() > 1) {
-        // Time part exists, parse it
-        auto time_part = datetime_parts[1];
-        auto time_parts = StringUtil::Split(time_part, ':');
-        if (time_parts.size() >= 2) {
-            hour = stoi(time_parts[0]);
-            minute = stoi(time_parts[1]);
-            if (time_parts.size() == 3) {
-                second = stoi(time_parts[2]);
-            }
+    days = date.days;
+    micros = 0;
+}
+
+// Convert rows [offset, offset + count) of a timestamp or date column into Jalali text, count <= STANDARD_VECTOR_SIZE
+template <JalaliOutputMode MODE, bool PERSIAN = false, class INPUT_TYPE = timestamp_t>
+static void GregorianToJalaliBatch(JalaliLocalState &lstate, const UnifiedVectorFormat &gregorian_data, idx_t offset,
+                                   idx_t count, Vector &result) {
+    auto gregorian_values = UnifiedVectorFormat::GetData<INPUT_TYPE>(gregorian_data);
+
+    // Stage 1: timestamps to day numbers and time of day
+    for (idx_t i = 0; i < count; i++) {
+        auto idx = gregorian_data.sel->get_index(offset + i);
+        if (!gregorian_data.validity.RowIsValid(idx)) {
+            lstate.days[i] = 0;
+            lstate.micros[i] = 0;
+            continue;
         }
+        SplitGregorian(gregorian_values[idx], lstate.days[i], lstate.micros[i]);
     }
+    JalaliFormatBatch<MODE, PERSIAN>(lstate, gregorian_data, offset, count, result);
+}
 
-    // If `end_of_day` is true, set time to 23:59:59
-    if (end_of_day) {
-        hour = 23;
-        minute = 59;
-        second = 59;
+// Gregorian "YYYY-MM-DD[ HH:MM[:SS[.ffffff]]][offset]" text straight to Jalali text. The Gregorian fields go to day
+// numbers in the scratch columns and through the same formatting stages as gregorian_to_jalali, so no TIMESTAMP
+// vector is materialized. The date and time layout is the one JalaliParser reads; a UTC offset is normalized to UTC.
+static void GregorianTextToJalaliFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
+
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
+
+    UnifiedVectorFormat text_data;
+    args.data[0].ToUnifiedFormat(args.size(), text_data);
+    auto text_values = UnifiedVectorFormat::GetData<string_t>(text_data);
+
+    // Stage 1: parse the Gregorian fields into day numbers and time of day
+    JalaliParts parts;
+    for (idx_t i = 0; i < count; i++) {
+        auto idx = text_data.sel->get_index(i);
+        if (!text_data.validity.RowIsValid(idx)) {
+            lstate.days[i] = 0;
+            lstate.micros[i] = 0;
+            continue;
+        }
+        auto &text = text_values[idx];
+        if (!JalaliParser::TryParse(text.GetData(), text.GetSize(), parts) || !parts.time_in_range ||
+            !Date::IsValid(parts.year, parts.month, parts.day)) {
+            throw InvalidInputException("Invalid Gregorian date: \"%s\"", text.GetString());
+        }
+        auto days = Date::FromDate(parts.year, parts.month, parts.day).days;
+        timestamp_t utc;
+        if (!JalaliCalendar::TryMakeTimestamp(days, parts.micros - parts.offset_micros, utc)) {
+            throw InvalidInputException("Gregorian date out of range: \"%s\" is outside the TIMESTAMP range",
+                                        text.GetString());
+        }
+        JalaliCalendar::SplitTimestamp(utc, lstate.days[i], lstate.micros[i]);
     }
 
-    // Create the `date_t` part
-    auto gregorian_date = duckdb::Date::FromDate(gy, gm, gd);
-
-    // Create the `dtime_t` part (time)
-    auto gregorian_time = duckdb::Time::FromTime(hour, minute, second);
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    JalaliFormatBatch<JalaliOutputMode::AUTO>(lstate, text_data, 0, count, result);
 
-    // Return the combined timestamp
-    return duckdb::Timestamp::FromDatetime(gregorian_date, gregorian_time);
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
 }
 
 // Scalar function for converting Jalali to Gregorian with time handling
-inline void JalaliToGregorianScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
-    auto &jalali_vector = args.data[0];
-    auto &end_of_day_vector = args.data[1];
-
-    // Using BinaryExecutor for two input parameters (string_t for date, bool for end_of_day)
-    BinaryExecutor::Execute<string_t, bool, timestamp_t>(jalali_vector, end_of_day_vector, result, args.size(),
-                                                   [&](string_t jalali_datetime, bool end_of_day) {
-        // Convert Jalali datetime to Gregorian datetime
-        return JalaliToGregorian(jalali_datetime, end_of_day);
-    });
+static void JalaliToGregorianScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
+
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
+
+    UnifiedVectorFormat jalali_data;
+    UnifiedVectorFormat end_of_day_data;
+    args.data[0].ToUnifiedFormat(args.size(), jalali_data);
+    args.data[1].ToUnifiedFormat(args.size(), end_of_day_data);
+
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    JalaliToGregorianBatch(lstate, jalali_data, end_of_day_data, 0, count, FlatVector::GetData<timestamp_t>(result),
+                           FlatVector::Validity(result));
+
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
 }
 
+// Jalali text to a TIMESTAMP WITH TIME ZONE; text without a UTC offset is taken to be in UTC
+static void JalaliToGregorianTzFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
+
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
+
+    UnifiedVectorFormat jalali_data;
+    UnifiedVectorFormat end_of_day_data;
+    args.data[0].ToUnifiedFormat(args.size(), jalali_data);
+    Vector end_of_day(Value::BOOLEAN(false));
+    end_of_day.ToUnifiedFormat(args.size(), end_of_day_data);
 
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    JalaliToGregorianBatch(lstate, jalali_data, end_of_day_data, 0, count, FlatVector::GetData<timestamp_t>(result),
+                           FlatVector::Validity(result));
 
-// Helper function to convert Gregorian date to Jalali date with optional time component
-string GregorianToJalali(timestamp_t gregorian_timestamp) {
-    // Extract date and time components
-    date_t gregorian_date = Timestamp::GetDate(gregorian_timestamp);
-    dtime_t gregorian_time = Timestamp::GetTime(gregorian_timestamp);
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
+}
 
-    int gy, gm, gd;
-    Date::Convert(gregorian_date, gy, gm, gd);
+// Scalar function for converting Gregorian to Jalali with time handling
+template <JalaliOutputMode MODE, bool PERSIAN = false, class INPUT_TYPE = timestamp_t>
+static void GregorianToJalaliScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
 
-    int jy, jm, jd;
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
 
-    int g_days_in_month[] = { 31, (Date::IsLeapYear(gy) ? 29 : 28), 31, 30, 31, 30,
-                              31, 31, 30, 31, 30, 31 };
-    int j_days_in_month[] = { 31, 31, 31, 31, 31, 31,
-                              30, 30, 30, 30, 30, 29 };
+    UnifiedVectorFormat gregorian_data;
+    args.data[0].ToUnifiedFormat(args.size(), gregorian_data);
 
-    int gy2 = gy - 1600;
-    int gm2 = gm - 1;
-    int gd2 = gd - 1;
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    GregorianToJalaliBatch<MODE, PERSIAN, INPUT_TYPE>(lstate, gregorian_data, 0, count, result);
 
-    long g_day_no = 365 * gy2 + (gy2 + 3) / 4 - (gy2 + 99) / 100 + (gy2 + 399) / 400;
-    for (int i = 0; i < gm2; ++i) {
-        g_day_no += g_days_in_month[i];
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
     }
-    g_day_no += gd2;
+}
 
-    long j_day_no = g_day_no - 79;
+//===--------------------------------------------------------------------===//
+// LIST and ARRAY variants
+//===--------------------------------------------------------------------===//
+// The nested variants convert the flat child vector in one pass and reuse the list offsets and lengths
+// (or the fixed array size) of the input for the result.
+
+// Convert the whole child vector of a LIST or ARRAY, batch by batch
+template <JalaliOutputMode MODE>
+static void GregorianToJalaliChild(JalaliLocalState &lstate, Vector &child, idx_t child_count, Vector &result_child) {
+    UnifiedVectorFormat child_data;
+    child.ToUnifiedFormat(child_count, child_data);
+    for (idx_t offset = 0; offset < child_count; offset += STANDARD_VECTOR_SIZE) {
+        auto batch_count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, child_count - offset);
+        GregorianToJalaliBatch<MODE>(lstate, child_data, offset, batch_count, result_child);
+    }
+}
 
-    long j_np = j_day_no / 12053;
-    j_day_no = j_day_no % 12053;
+static void JalaliToGregorianChild(JalaliLocalState &lstate, Vector &child, Vector &end_of_day_child,
+                                   idx_t child_count, Vector &result_child) {
+    UnifiedVectorFormat child_data;
+    UnifiedVectorFormat end_of_day_data;
+    child.ToUnifiedFormat(child_count, child_data);
+    end_of_day_child.ToUnifiedFormat(child_count, end_of_day_data);
+    auto result_data = FlatVector::GetData<timestamp_t>(result_child);
+    auto &result_validity = FlatVector::Validity(result_child);
+    for (idx_t offset = 0; offset < child_count; offset += STANDARD_VECTOR_SIZE) {
+        auto batch_count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, child_count - offset);
+        JalaliToGregorianBatch(lstate, child_data, end_of_day_data, offset, batch_count, result_data,
+                               result_validity);
+    }
+}
 
-    jy = 979 + 33 * j_np + 4 * (j_day_no / 1461);
-    j_day_no %= 1461;
+// Spread the per-row end_of_day flag over the elements of each list. Elements no valid row refers to get a NULL
+// flag, so they are skipped instead of parsed.
+static void JalaliSpreadEndOfDay(Vector &list, Vector &end_of_day, idx_t count, idx_t child_count,
+                                 Vector &end_of_day_child) {
+    UnifiedVectorFormat list_data;
+    UnifiedVectorFormat end_of_day_data;
+    list.ToUnifiedFormat(count, list_data);
+    end_of_day.ToUnifiedFormat(count, end_of_day_data);
+    auto entries = UnifiedVectorFormat::GetData<list_entry_t>(list_data);
+    auto flags = UnifiedVectorFormat::GetData<bool>(end_of_day_data);
+    auto child_flags = FlatVector::GetData<bool>(end_of_day_child);
+    auto &child_validity = FlatVector::Validity(end_of_day_child);
+    child_validity.SetAllInvalid(child_count);
+    for (idx_t i = 0; i < count; i++) {
+        auto list_idx = list_data.sel->get_index(i);
+        auto flag_idx = end_of_day_data.sel->get_index(i);
+        if (!list_data.validity.RowIsValid(list_idx) || !end_of_day_data.validity.RowIsValid(flag_idx)) {
+            continue;
+        }
+        auto &entry = entries[list_idx];
+        for (idx_t k = entry.offset; k < entry.offset + entry.length; k++) {
+            child_flags[k] = flags[flag_idx];
+            child_validity.SetValid(k);
+        }
+    }
+}
 
-    if (j_day_no >= 366) {
-        jy += (j_day_no - 1) / 365;
-        j_day_no = (j_day_no - 1) % 365;
+template <JalaliOutputMode MODE>
+static void GregorianToJalaliListFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
+    auto &input = args.data[0];
+
+    UnaryExecutor::Execute<list_entry_t, list_entry_t>(input, result, args.size(),
+                                                       [](list_entry_t entry) { return entry; });
+    auto child_count = ListVector::GetListSize(input);
+    ListVector::Reserve(result, child_count);
+    GregorianToJalaliChild<MODE>(lstate, ListVector::GetEntry(input), child_count, ListVector::GetEntry(result));
+    ListVector::SetListSize(result, child_count);
+}
+
+static void JalaliToGregorianListFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
+    auto &input = args.data[0];
+
+    BinaryExecutor::Execute<list_entry_t, bool, list_entry_t>(input, args.data[1], result, args.size(),
+                                                              [](list_entry_t entry, bool) { return entry; });
+    auto child_count = ListVector::GetListSize(input);
+    Vector end_of_day_child(LogicalType::BOOLEAN, MaxValue<idx_t>(child_count, 1));
+    JalaliSpreadEndOfDay(input, args.data[1], args.size(), child_count, end_of_day_child);
+    ListVector::Reserve(result, child_count);
+    JalaliToGregorianChild(lstate, ListVector::GetEntry(input), end_of_day_child, child_count,
+                           ListVector::GetEntry(result));
+    ListVector::SetListSize(result, child_count);
+}
+
+template <JalaliOutputMode MODE>
+static void GregorianToJalaliArrayFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
+    auto &input = args.data[0];
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
+
+    input.Flatten(count);
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    FlatVector::SetValidity(result, FlatVector::Validity(input));
+    auto child_count = count * ArrayType::GetSize(input.GetType());
+    GregorianToJalaliChild<MODE>(lstate, ArrayVector::GetEntry(input), child_count, ArrayVector::GetEntry(result));
+
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
     }
+}
 
-    int i = 0;
-    while (i < 11 && j_day_no >= j_days_in_month[i]) {
-        j_day_no -= j_days_in_month[i];
-        ++i;
+static void JalaliToGregorianArrayFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &lstate = ExecuteFunctionState::GetFunctionState(state)->Cast<JalaliLocalState>();
+    auto &input = args.data[0];
+    auto &end_of_day = args.data[1];
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
+
+    // Like the scalar and LIST forms, a NULL end_of_day flag gives a NULL row
+    if (end_of_day.GetVectorType() == VectorType::CONSTANT_VECTOR && ConstantVector::IsNull(end_of_day)) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+        ConstantVector::SetNull(result, true);
+        return;
     }
-    jm = i + 1;
-    jd = j_day_no + 1;
-
-    // Construct time string
-    int hour, minute, second, micros;
-    Time::Convert(gregorian_time, hour, minute, second, micros);
-
-    // Format the Jalali date and time
-    char buffer[25];
-    if (hour == 0 && minute == 0 && second == 0 && micros == 0) {
-        // Date only
-        snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", jy, jm, jd);
+
+    input.Flatten(count);
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    auto &result_validity = FlatVector::Validity(result);
+    result_validity.Copy(FlatVector::Validity(input), count);
+    auto array_size = ArrayType::GetSize(input.GetType());
+    auto child_count = count * array_size;
+
+    // Every row owns array_size consecutive elements. Elements of NULL rows get a NULL flag so they are not parsed.
+    auto &input_validity = FlatVector::Validity(input);
+    Vector end_of_day_child(LogicalType::BOOLEAN, MaxValue<idx_t>(child_count, 1));
+    if (end_of_day.GetVectorType() == VectorType::CONSTANT_VECTOR && input_validity.AllValid()) {
+        end_of_day_child.Reference(end_of_day);
     } else {
-        // Date and time
-        snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d",
-                 jy, jm, jd, hour, minute, second);
+        UnifiedVectorFormat end_of_day_data;
+        end_of_day.ToUnifiedFormat(count, end_of_day_data);
+        auto flags = UnifiedVectorFormat::GetData<bool>(end_of_day_data);
+        auto child_flags = FlatVector::GetData<bool>(end_of_day_child);
+        for (idx_t i = 0; i < count; i++) {
+            auto flag_idx = end_of_day_data.sel->get_index(i);
+            auto flag_valid = input_validity.RowIsValid(i) && end_of_day_data.validity.RowIsValid(flag_idx);
+            if (!flag_valid) {
+                result_validity.SetInvalid(i);
+            }
+            for (idx_t k = i * array_size; k < (i + 1) * array_size; k++) {
+                child_flags[k] = flag_valid && flags[flag_idx];
+                if (!flag_valid) {
+                    FlatVector::SetNull(end_of_day_child, k, true);
+                }
+            }
+        }
     }
+    JalaliToGregorianChild(lstate, ArrayVector::GetEntry(input), end_of_day_child, child_count,
+                           ArrayVector::GetEntry(result));
 
-    return string(buffer);
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
 }
 
-// Scalar function for converting Gregorian to Jalali with time handling
-inline void GregorianToJalaliScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
-    auto &gregorian_vector = args.data[0];
-
-    UnaryExecutor::Execute<timestamp_t, string_t>(gregorian_vector, result, args.size(),
-                                                  [&](timestamp_t gregorian_timestamp) {
-        // Convert Gregorian timestamp to Jalali date string
-        string jalali_datetime = GregorianToJalali(gregorian_timestamp);
-        return StringVector::AddString(result, jalali_datetime);
+// jalali_date_key(text): the DATE of a canonical "YYYY-MM-DD" Jalali string, NULL for anything else. Canonical
+// strings round-trip exactly through gregorian_to_jalali(key, 'date'), so a legacy text column can be stored as a
+// 4-byte DATE key (which DuckDB bit-packs and keeps min/max for) plus the raw text of the non-conforming rows only.
+static void JalaliDateKeyFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    UnaryExecutor::ExecuteWithNulls<string_t, date_t>(
+        args.data[0], result, args.size(), [&](string_t input, ValidityMask &mask, idx_t idx) {
+            int32_t jy, jm, jd;
+            if (!JalaliParser::TryParseCanonical(input.GetData(), input.GetSize(), jy, jm, jd)) {
+                mask.SetInvalid(idx);
+                return date_t();
+            }
+            return date_t(JalaliCalendar::ToDays(jy, jm, jd));
+        });
+}
+
+// ASCII digits to Persian digits, everything else copied unchanged
+static void JalaliPersianDigitsFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](string_t input) {
+        auto data = input.GetData();
+        auto length = input.GetSize();
+        auto target = StringVector::EmptyString(result, length + JalaliDigits::CountAscii(data, length));
+        JalaliDigits::ToPersian(data, length, target.GetDataWriteable());
+        target.Finalize();
+        return target;
+    });
+}
+
+// Persian and Arabic-Indic digits to ASCII digits, everything else copied unchanged
+static void JalaliAsciiDigitsFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    UnaryExecutor::Execute<string_t, string_t>(args.data[0], result, args.size(), [&](string_t input) {
+        auto data = input.GetData();
+        auto length = input.GetSize();
+        auto target = StringVector::EmptyString(result, length - JalaliDigits::CountNative(data, length));
+        JalaliDigits::ToAscii(data, length, target.GetDataWriteable());
+        target.Finalize();
+        return target;
     });
 }
 
+// Give ARRAY overloads a result of the same size as their input
+static unique_ptr<FunctionData> JalaliArrayBind(ClientContext &context, ScalarFunction &bound_function,
+                                                vector<unique_ptr<Expression>> &arguments) {
+    auto &input_type = arguments[0]->return_type;
+    if (input_type.id() != LogicalTypeId::ARRAY) {
+        throw BinderException("%s: expected an ARRAY argument", bound_function.name);
+    }
+    auto child_type = ArrayType::GetChildType(bound_function.return_type);
+    auto array_size = ArrayType::GetSize(input_type);
+    bound_function.arguments[0] = LogicalType::ARRAY(ArrayType::GetChildType(input_type), array_size);
+    bound_function.return_type = LogicalType::ARRAY(child_type, array_size);
+    return nullptr;
+}
+
+static bool GregorianDayRange(timestamp_t, const BaseStatistics &stats, int32_t &min_days, int32_t &max_days) {
+    return JalaliFunctions::TimestampDayRange(stats, min_days, max_days);
+}
+
+static bool GregorianDayRange(date_t, const BaseStatistics &stats, int32_t &min_days, int32_t &max_days) {
+    if (!NumericStats::HasMinMax(stats)) {
+        return false;
+    }
+    auto min_date = NumericStats::GetMin<date_t>(stats);
+    auto max_date = NumericStats::GetMax<date_t>(stats);
+    timestamp_t ts;
+    if (!JalaliCalendar::TryMakeTimestamp(min_date.days, 0, ts) ||
+        !JalaliCalendar::TryMakeTimestamp(max_date.days, 0, ts)) {
+        return false;
+    }
+    min_days = min_date.days;
+    max_days = max_date.days;
+    return true;
+}
+
+// Fixed-width date modes sort like the dates they format, so the formatted min and max bound the result, and there
+// are at most as many distinct values as days in the input range
+template <JalaliOutputMode MODE, class INPUT_TYPE>
+static unique_ptr<BaseStatistics> GregorianToJalaliDateStats(ClientContext &context, FunctionStatisticsInput &input) {
+    auto &child_stats = input.child_stats;
+    int32_t min_days, max_days;
+    if (!GregorianDayRange(INPUT_TYPE(), child_stats[0], min_days, max_days)) {
+        return nullptr;
+    }
+    auto result = StringStats::CreateEmpty(input.expr.return_type);
+    for (auto days : {min_days, max_days}) {
+        int32_t jy, jm, jd;
+        JalaliCalendar::FromDays(days, jy, jm, jd);
+        if (!JalaliFormatter::YearFits(jy)) {
+            return nullptr;
+        }
+        char buffer[JalaliFormatter::MAX_LENGTH];
+        auto length = JalaliFormatter::Write(MODE, buffer, jy, jm, jd, 0);
+        StringStats::Update(result, string_t(buffer, uint32_t(length)));
+    }
+    result.CopyValidity(child_stats[0]);
+    result.SetDistinctCount(idx_t(int64_t(max_days) - int64_t(min_days)) + 1);
+    return result.ToUnique();
+}
+
+template <bool PERSIAN, class INPUT_TYPE>
+static scalar_function_t GregorianToJalaliKernel(JalaliOutputMode mode) {
+    switch (mode) {
+    case JalaliOutputMode::DATE:
+        return GregorianToJalaliScalarFun<JalaliOutputMode::DATE, PERSIAN, INPUT_TYPE>;
+    case JalaliOutputMode::DATETIME:
+        return GregorianToJalaliScalarFun<JalaliOutputMode::DATETIME, PERSIAN, INPUT_TYPE>;
+    case JalaliOutputMode::DATETIME_MICROS:
+        return GregorianToJalaliScalarFun<JalaliOutputMode::DATETIME_MICROS, PERSIAN, INPUT_TYPE>;
+    case JalaliOutputMode::COMPACT:
+        return GregorianToJalaliScalarFun<JalaliOutputMode::COMPACT, PERSIAN, INPUT_TYPE>;
+    default:
+        return GregorianToJalaliScalarFun<JalaliOutputMode::AUTO, PERSIAN, INPUT_TYPE>;
+    }
+}
+
+template <class INPUT_TYPE>
+static void GregorianToJalaliBindKernel(ScalarFunction &bound_function, JalaliOutputMode mode, bool persian) {
+    bound_function.function =
+        persian ? GregorianToJalaliKernel<true, INPUT_TYPE>(mode) : GregorianToJalaliKernel<false, INPUT_TYPE>(mode);
+    if (!persian && mode == JalaliOutputMode::DATE) {
+        bound_function.statistics = GregorianToJalaliDateStats<JalaliOutputMode::DATE, INPUT_TYPE>;
+    } else if (!persian && mode == JalaliOutputMode::COMPACT) {
+        bound_function.statistics = GregorianToJalaliDateStats<JalaliOutputMode::COMPACT, INPUT_TYPE>;
+    }
+}
+
+// Resolve the constant output mode (and Persian digits flag) of gregorian_to_jalali(ts, mode[, persian_digits])
+// into its kernel. A DATE argument is read as is instead of through a cast to TIMESTAMP, which keeps its statistics.
+static unique_ptr<FunctionData> GregorianToJalaliModeBind(ClientContext &context, ScalarFunction &bound_function,
+                                                          vector<unique_ptr<Expression>> &arguments) {
+    auto mode_name = JalaliFunctions::ConstantStringArgument(context, bound_function.name, *arguments[1]);
+    auto mode = JalaliFormatter::ParseMode(mode_name);
+    bool persian = false;
+    if (arguments.size() > 2) {
+        persian = JalaliFunctions::ConstantArgument(context, bound_function.name, *arguments[2]).GetValue<bool>();
+        Function::EraseArgument(bound_function, arguments, 2);
+    }
+    if (arguments[0]->return_type.id() == LogicalTypeId::DATE) {
+        bound_function.arguments[0] = LogicalType::DATE;
+        GregorianToJalaliBindKernel<date_t>(bound_function, mode, persian);
+    } else {
+        GregorianToJalaliBindKernel<timestamp_t>(bound_function, mode, persian);
+    }
+    Function::EraseArgument(bound_function, arguments, 1);
+    return nullptr;
+}
+
 static void LoadInternal(DatabaseInstance &instance) {
-    // Register the Jalali to Gregorian scalar function
-    auto jalali_to_gregorian_scalar_function = ScalarFunction(
-        "jalali_to_gregorian", {LogicalType::VARCHAR, LogicalType::BOOLEAN},
-        LogicalType::TIMESTAMP, JalaliToGregorianScalarFun);
-    ExtensionUtil::RegisterFunction(instance, jalali_to_gregorian_scalar_function);
-
-    // Register the Gregorian to Jalali scalar function
-    auto gregorian_to_jalali_scalar_function = ScalarFunction(
-        "gregorian_to_jalali", {LogicalType::TIMESTAMP}, LogicalType::VARCHAR,
-        GregorianToJalaliScalarFun);
-    ExtensionUtil::RegisterFunction(instance, gregorian_to_jalali_scalar_function);
+    // Register the Jalali to Gregorian scalar function, for scalars, lists and arrays
+    ScalarFunctionSet jalali_to_gregorian_set("jalali_to_gregorian");
+    ScalarFunction jalali_to_gregorian_scalar_function({LogicalType::VARCHAR, LogicalType::BOOLEAN},
+                                                       LogicalType::TIMESTAMP, JalaliToGregorianScalarFun);
+    jalali_to_gregorian_set.AddFunction(jalali_to_gregorian_scalar_function);
+    jalali_to_gregorian_set.AddFunction(ScalarFunction({LogicalType::LIST(LogicalType::VARCHAR), LogicalType::BOOLEAN},
+                                                       LogicalType::LIST(LogicalType::TIMESTAMP),
+                                                       JalaliToGregorianListFun));
+    jalali_to_gregorian_set.AddFunction(
+        ScalarFunction({LogicalType::ARRAY(LogicalType::VARCHAR, optional_idx()), LogicalType::BOOLEAN},
+                       LogicalType::ARRAY(LogicalType::TIMESTAMP, optional_idx()), JalaliToGregorianArrayFun,
+                       JalaliArrayBind));
+    for (auto &function : jalali_to_gregorian_set.functions) {
+        function.init_local_state = JalaliInitLocalState;
+    }
+    ExtensionUtil::RegisterFunction(instance, jalali_to_gregorian_set);
+
+    ScalarFunction jalali_to_gregorian_tz_function("jalali_to_gregorian_tz", {LogicalType::VARCHAR},
+                                                   LogicalType::TIMESTAMP_TZ, JalaliToGregorianTzFun);
+    jalali_to_gregorian_tz_function.init_local_state = JalaliInitLocalState;
+    ExtensionUtil::RegisterFunction(instance, jalali_to_gregorian_tz_function);
+
+    // Register the Gregorian to Jalali scalar function, optionally with a fixed output mode
+    ScalarFunctionSet gregorian_to_jalali_set("gregorian_to_jalali");
+    gregorian_to_jalali_set.AddFunction(ScalarFunction({LogicalType::TIMESTAMP}, LogicalType::VARCHAR,
+                                                       GregorianToJalaliScalarFun<JalaliOutputMode::AUTO>));
+    gregorian_to_jalali_set.AddFunction(ScalarFunction({LogicalType::TIMESTAMP, LogicalType::VARCHAR},
+                                                       LogicalType::VARCHAR,
+                                                       GregorianToJalaliScalarFun<JalaliOutputMode::AUTO>,
+                                                       GregorianToJalaliModeBind));
+    gregorian_to_jalali_set.AddFunction(
+        ScalarFunction({LogicalType::TIMESTAMP, LogicalType::VARCHAR, LogicalType::BOOLEAN}, LogicalType::VARCHAR,
+                       GregorianToJalaliScalarFun<JalaliOutputMode::AUTO>, GregorianToJalaliModeBind));
+    gregorian_to_jalali_set.AddFunction(ScalarFunction({LogicalType::LIST(LogicalType::TIMESTAMP)},
+                                                       LogicalType::LIST(LogicalType::VARCHAR),
+                                                       GregorianToJalaliListFun<JalaliOutputMode::AUTO>));
+    gregorian_to_jalali_set.AddFunction(ScalarFunction({LogicalType::ARRAY(LogicalType::TIMESTAMP, optional_idx())},
+                                                       LogicalType::ARRAY(LogicalType::VARCHAR, optional_idx()),
+                                                       GregorianToJalaliArrayFun<JalaliOutputMode::AUTO>,
+                                                       JalaliArrayBind));
+    for (auto &function : gregorian_to_jalali_set.functions) {
+        function.init_local_state = JalaliInitLocalState;
+    }
+    ExtensionUtil::RegisterFunction(instance, gregorian_to_jalali_set);
+
+    ScalarFunction gregorian_text_to_jalali_function("gregorian_text_to_jalali", {LogicalType::VARCHAR},
+                                                     LogicalType::VARCHAR, GregorianTextToJalaliFun);
+    gregorian_text_to_jalali_function.init_local_state = JalaliInitLocalState;
+    ExtensionUtil::RegisterFunction(instance, gregorian_text_to_jalali_function);
+
+    ScalarFunction jalali_date_key_function("jalali_date_key", {LogicalType::VARCHAR}, LogicalType::DATE,
+                                            JalaliDateKeyFun);
+    ExtensionUtil::RegisterFunction(instance, jalali_date_key_function);
+
+    ScalarFunction persian_digits_function("jalali_persian_digits", {LogicalType::VARCHAR}, LogicalType::VARCHAR,
+                                           JalaliPersianDigitsFun);
+    ExtensionUtil::RegisterFunction(instance, persian_digits_function);
+    ScalarFunction ascii_digits_function("jalali_ascii_digits", {LogicalType::VARCHAR}, LogicalType::VARCHAR,
+                                         JalaliAsciiDigitsFun);
+    ExtensionUtil::RegisterFunction(instance, ascii_digits_function);
+
+    JalaliFunctions::RegisterPeriodFunctions(instance);
+    JalaliFunctions::RegisterSeriesFunctions(instance);
+    JalaliFunctions::RegisterFiscalFunctions(instance);
+    JalaliFunctions::RegisterArithmeticFunctions(instance);
+    JalaliFunctions::RegisterHistogramFunctions(instance);
+    JalaliFunctions::RegisterActivityFunctions(instance);
+    JalaliFunctions::RegisterMonthFunctions(instance);
+    JalaliFunctions::RegisterBusinessFunctions(instance);
+    JalaliFunctions::RegisterLiteralTypes(instance);
+    JalaliFunctions::RegisterStatsFunctions(instance);
+    JalaliFunctions::RegisterExtractFunctions(instance);
 }
 
 void JalaliExtension::Load(DuckDB &db) {
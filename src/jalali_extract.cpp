@@ -0,0 +1,188 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+// jalali_extract_dates(text): every Jalali date in free text, in order of appearance. A date is a four digit year,
+// a month and a day separated by '-', '/' or '.' (the same separator twice), optionally followed by ' ' or 'T' and
+// HH:MM[:SS]. Digits may be ASCII, Persian or Arabic-Indic. Candidates that are part of a longer digit run or are
+// not valid Jalali dates are skipped.
+struct JalaliDateScanner {
+    // Digit at pos and its width in bytes, or false
+    static inline bool ReadDigit(const char *data, idx_t len, idx_t pos, int32_t &digit, idx_t &width) {
+        auto c = uint8_t(data[pos]);
+        if (uint8_t(c - '0') < 10) {
+            digit = c - '0';
+            width = 1;
+            return true;
+        }
+        if (c != JalaliDigits::PERSIAN_LEAD && c != JalaliDigits::ARABIC_LEAD) {
+            return false;
+        }
+        digit = JalaliDigits::NativeDigit(data, len, pos);
+        width = 2;
+        return digit >= 0;
+    }
+
+    static inline bool IsDigitAt(const char *data, idx_t len, idx_t pos) {
+        int32_t digit;
+        idx_t width;
+        return pos < len && ReadDigit(data, len, pos, digit, width);
+    }
+
+    // A number of min_digits to max_digits digits; fails on a longer run
+    static bool ReadNumber(const char *data, idx_t len, idx_t &pos, idx_t min_digits, idx_t max_digits,
+                           int32_t &value) {
+        idx_t digits = 0;
+        value = 0;
+        int32_t digit;
+        idx_t width;
+        while (pos < len && ReadDigit(data, len, pos, digit, width)) {
+            if (digits == max_digits) {
+                return false;
+            }
+            value = value * 10 + digit;
+            pos += width;
+            digits++;
+        }
+        return digits >= min_digits;
+    }
+
+    static constexpr uint64_t ONES = 0x0101010101010101ULL;
+    static constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+
+    // Whether any of the 8 bytes can start a digit: an ASCII digit or a Persian or Arabic-Indic lead byte
+    static inline bool HasDigitStart(uint64_t word) {
+        // Bytes strictly between '0' - 1 and '9' + 1; bytes with the high bit set are masked out by ~word
+        auto low = word & (ONES * 0x7F);
+        auto ascii = (ONES * (0x7F + '9' + 1) - low) & ~word & (low + ONES * (0x7F - ('0' - 1))) & HIGHS;
+        // The two lead bytes 0xD9 and 0xDB differ only in bit 1, so one zero-byte test finds both
+        auto lead = (word | (ONES * 0x02)) ^ (ONES * JalaliDigits::PERSIAN_LEAD);
+        return (ascii | ((lead - ONES) & ~lead & HIGHS)) != 0;
+    }
+
+    static inline bool IsSeparator(char c) {
+        return c == '-' || c == '/' || c == '.';
+    }
+
+    // Try to read a date starting at the first digit of a run; on success pos is moved past it
+    static bool TryReadDate(const char *data, idx_t len, idx_t &pos, timestamp_t &result) {
+        idx_t p = pos;
+        int32_t jy, jm, jd;
+        if (!ReadNumber(data, len, p, 4, 4, jy) || p >= len || !IsSeparator(data[p])) {
+            return false;
+        }
+        auto separator = data[p++];
+        if (!ReadNumber(data, len, p, 1, 2, jm) || p >= len || data[p] != separator) {
+            return false;
+        }
+        p++;
+        if (!ReadNumber(data, len, p, 1, 2, jd) || !JalaliCalendar::IsValid(jy, jm, jd)) {
+            return false;
+        }
+        int64_t micros = 0;
+        if (p + 1 < len && (data[p] == ' ' || data[p] == 'T') && IsDigitAt(data, len, p + 1)) {
+            idx_t q = p + 1;
+            int32_t hour, minute, second = 0;
+            if (ReadNumber(data, len, q, 1, 2, hour) && q < len && data[q] == ':' &&
+                ReadNumber(data, len, ++q, 2, 2, minute)) {
+                bool valid = true;
+                if (q + 1 < len && data[q] == ':' && IsDigitAt(data, len, q + 1)) {
+                    valid = ReadNumber(data, len, ++q, 2, 2, second);
+                }
+                if (valid && hour < 24 && minute < 60 && second < 60) {
+                    micros = (int64_t(hour) * 3600 + minute * 60 + second) * Interval::MICROS_PER_SEC;
+                    p = q;
+                }
+            }
+        }
+        result = JalaliCalendar::MakeTimestamp(JalaliCalendar::ToDays(jy, jm, jd), micros);
+        pos = p;
+        return true;
+    }
+
+    static void Scan(const char *data, idx_t len, vector<timestamp_t> &found) {
+        idx_t pos = 0;
+        while (pos < len) {
+            // Skip quickly to the next byte that can start a digit: a word at a time, then to the byte within it
+            while (pos + sizeof(uint64_t) <= len) {
+                uint64_t word;
+                memcpy(&word, data + pos, sizeof(uint64_t));
+                if (HasDigitStart(word)) {
+                    break;
+                }
+                pos += sizeof(uint64_t);
+            }
+            while (pos < len) {
+                auto c = uint8_t(data[pos]);
+                if (uint8_t(c - '0') < 10 || c == JalaliDigits::PERSIAN_LEAD || c == JalaliDigits::ARABIC_LEAD) {
+                    break;
+                }
+                pos++;
+            }
+            if (pos >= len) {
+                break;
+            }
+            if (!IsDigitAt(data, len, pos)) {
+                pos++;
+                continue;
+            }
+            timestamp_t date;
+            if (TryReadDate(data, len, pos, date)) {
+                found.push_back(date);
+                continue;
+            }
+            // Not a date: skip the rest of this digit run
+            int32_t digit;
+            idx_t width;
+            while (pos < len && ReadDigit(data, len, pos, digit, width)) {
+                pos += width;
+            }
+        }
+    }
+};
+
+static void JalaliExtractDatesFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    const bool all_constant = args.AllConstant();
+    const idx_t count = all_constant ? 1 : args.size();
+
+    UnifiedVectorFormat text_data;
+    args.data[0].ToUnifiedFormat(args.size(), text_data);
+    auto texts = UnifiedVectorFormat::GetData<string_t>(text_data);
+
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    auto list_entries = FlatVector::GetData<list_entry_t>(result);
+    auto &result_validity = FlatVector::Validity(result);
+
+    // Scan every row first, then copy all dates into the child vector at once
+    vector<timestamp_t> found;
+    for (idx_t i = 0; i < count; i++) {
+        auto idx = text_data.sel->get_index(i);
+        if (!text_data.validity.RowIsValid(idx)) {
+            result_validity.SetInvalid(i);
+            continue;
+        }
+        list_entries[i].offset = found.size();
+        JalaliDateScanner::Scan(texts[idx].GetData(), texts[idx].GetSize(), found);
+        list_entries[i].length = found.size() - list_entries[i].offset;
+    }
+    ListVector::Reserve(result, found.size());
+    auto &child = ListVector::GetEntry(result);
+    if (!found.empty()) {
+        memcpy(FlatVector::GetData<timestamp_t>(child), found.data(), found.size() * sizeof(timestamp_t));
+    }
+    ListVector::SetListSize(result, found.size());
+    if (all_constant) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
+}
+
+void JalaliFunctions::RegisterExtractFunctions(DatabaseInstance &instance) {
+    ScalarFunction extract_function("jalali_extract_dates", {LogicalType::VARCHAR},
+                                    LogicalType::LIST(LogicalType::TIMESTAMP), JalaliExtractDatesFun);
+    ExtensionUtil::RegisterFunction(instance, extract_function);
+}
+
+} // namespace duckdb
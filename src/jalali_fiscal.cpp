@@ -0,0 +1,278 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "duckdb/function/pragma_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/storage/object_cache.hpp"
+
+#include <algorithm>
+
+namespace duckdb {
+
+// A fiscal calendar compiled into a sorted table of period start days. Every fiscal year has 12 periods and is
+// named after the Jalali year it starts in; the table covers fiscal years FIRST_YEAR to LAST_YEAR.
+struct JalaliFiscalCalendar {
+    static constexpr int32_t FIRST_YEAR = 1200;
+    static constexpr int32_t LAST_YEAR = 1600;
+    static constexpr idx_t PERIODS_PER_YEAR = 12;
+
+    string name;
+    int32_t start_month;
+    string pattern;
+    // Start day of every period, followed by the day after the last one
+    vector<int32_t> period_starts;
+
+    // Index of the period containing a day number, or false when it is outside the table
+    bool Lookup(int32_t days, idx_t &index) const {
+        auto entry = std::upper_bound(period_starts.begin(), period_starts.end(), days);
+        if (entry == period_starts.begin() || entry == period_starts.end()) {
+            return false;
+        }
+        index = idx_t(entry - period_starts.begin()) - 1;
+        return true;
+    }
+};
+
+// Start of a week-based fiscal year: the Saturday nearest to the first day of its start month
+static int32_t JalaliFiscalWeekYearStart(int32_t year, int32_t start_month) {
+    auto days = JalaliCalendar::ToDays(year, start_month, 1);
+    auto since_saturday = days - JalaliCalendar::FIRST_SATURDAY;
+    auto offset = since_saturday - JalaliCalendar::FloorDiv(since_saturday, 7) * 7;
+    return offset <= 3 ? days - offset : days + 7 - offset;
+}
+
+static shared_ptr<JalaliFiscalCalendar> JalaliCompileFiscalCalendar(const string &name, int32_t start_month,
+                                                                    const string &pattern) {
+    if (start_month < 1 || start_month > 12) {
+        throw InvalidInputException("Fiscal calendar start month must be between 1 and 12, got %d", start_month);
+    }
+    auto calendar = make_shared_ptr<JalaliFiscalCalendar>();
+    calendar->name = name;
+    calendar->start_month = start_month;
+    calendar->pattern = StringUtil::Lower(pattern);
+    auto &starts = calendar->period_starts;
+
+    if (calendar->pattern == "month") {
+        for (int32_t year = JalaliFiscalCalendar::FIRST_YEAR; year <= JalaliFiscalCalendar::LAST_YEAR + 1; year++) {
+            for (int32_t period = 0; period < 12; period++) {
+                auto month = start_month - 1 + period;
+                starts.push_back(JalaliCalendar::ToDays(year + month / 12, month % 12 + 1, 1));
+            }
+        }
+    } else if (calendar->pattern == "4-4-5" || calendar->pattern == "4-5-4" || calendar->pattern == "5-4-4") {
+        int32_t quarter_weeks[3];
+        for (idx_t i = 0; i < 3; i++) {
+            quarter_weeks[i] = calendar->pattern[i * 2] - '0';
+        }
+        // The last period of a year runs until the next year starts, absorbing the occasional 53rd week
+        for (int32_t year = JalaliFiscalCalendar::FIRST_YEAR; year <= JalaliFiscalCalendar::LAST_YEAR + 1; year++) {
+            auto year_start = JalaliFiscalWeekYearStart(year, start_month);
+            int32_t weeks = 0;
+            for (int32_t period = 0; period < 12; period++) {
+                starts.push_back(year_start + weeks * 7);
+                weeks += quarter_weeks[period % 3];
+            }
+        }
+    } else {
+        throw InvalidInputException("Unsupported fiscal calendar pattern \"%s\", expected month, 4-4-5, 4-5-4 or 5-4-4",
+                                    pattern);
+    }
+    // Keep the first period of the year after LAST_YEAR as the end sentinel
+    starts.resize((JalaliFiscalCalendar::LAST_YEAR - JalaliFiscalCalendar::FIRST_YEAR + 1) *
+                      JalaliFiscalCalendar::PERIODS_PER_YEAR +
+                  1);
+    return calendar;
+}
+
+// Fiscal calendars defined in a database, kept in its object cache
+class JalaliFiscalRegistry : public ObjectCacheEntry {
+public:
+    static string ObjectType() {
+        return "jalali_fiscal_registry";
+    }
+
+    string GetObjectType() override {
+        return ObjectType();
+    }
+
+    static JalaliFiscalRegistry &Get(ClientContext &context) {
+        return *ObjectCache::GetObjectCache(context).GetOrCreate<JalaliFiscalRegistry>(ObjectType());
+    }
+
+    void Create(shared_ptr<JalaliFiscalCalendar> calendar) {
+        lock_guard<mutex> guard(lock);
+        if (calendars.find(calendar->name) != calendars.end()) {
+            throw CatalogException("Jalali fiscal calendar \"%s\" already exists", calendar->name);
+        }
+        calendars[calendar->name] = std::move(calendar);
+    }
+
+    void Drop(const string &name) {
+        lock_guard<mutex> guard(lock);
+        if (calendars.erase(name) == 0) {
+            throw CatalogException("Jalali fiscal calendar \"%s\" does not exist", name);
+        }
+    }
+
+    shared_ptr<JalaliFiscalCalendar> Find(const string &name) {
+        lock_guard<mutex> guard(lock);
+        auto entry = calendars.find(name);
+        if (entry == calendars.end()) {
+            throw CatalogException("Jalali fiscal calendar \"%s\" does not exist", name);
+        }
+        return entry->second;
+    }
+
+private:
+    mutex lock;
+    case_insensitive_map_t<shared_ptr<JalaliFiscalCalendar>> calendars;
+};
+
+// PRAGMA jalali_create_fiscal_calendar(name, start_month, pattern)
+static void JalaliCreateFiscalCalendarPragma(ClientContext &context, const FunctionParameters &parameters) {
+    auto name = parameters.values[0].GetValue<string>();
+    auto start_month = parameters.values[1].GetValue<int32_t>();
+    auto pattern = parameters.values[2].GetValue<string>();
+    JalaliFiscalRegistry::Get(context).Create(JalaliCompileFiscalCalendar(name, start_month, pattern));
+}
+
+// PRAGMA jalali_drop_fiscal_calendar(name)
+static void JalaliDropFiscalCalendarPragma(ClientContext &context, const FunctionParameters &parameters) {
+    JalaliFiscalRegistry::Get(context).Drop(parameters.values[0].GetValue<string>());
+}
+
+//===--------------------------------------------------------------------===//
+// Fiscal period functions
+//===--------------------------------------------------------------------===//
+enum class JalaliFiscalPart : uint8_t { PERIOD, QUARTER, YEAR };
+
+struct JalaliFiscalBindData : public FunctionData {
+    JalaliFiscalBindData(shared_ptr<JalaliFiscalCalendar> calendar, JalaliFiscalPart part)
+        : calendar(std::move(calendar)), part(part) {
+    }
+
+    shared_ptr<JalaliFiscalCalendar> calendar;
+    JalaliFiscalPart part;
+
+    unique_ptr<FunctionData> Copy() const override {
+        return make_uniq<JalaliFiscalBindData>(calendar, part);
+    }
+
+    bool Equals(const FunctionData &other_p) const override {
+        auto &other = other_p.Cast<JalaliFiscalBindData>();
+        return calendar == other.calendar && part == other.part;
+    }
+};
+
+// jalali_fiscal_period(ts, name) and jalali_fiscal_year(ts, name)
+static unique_ptr<FunctionData> JalaliFiscalBind(ClientContext &context, ScalarFunction &bound_function,
+                                                 vector<unique_ptr<Expression>> &arguments) {
+    auto name = JalaliFunctions::ConstantStringArgument(context, bound_function.name, *arguments[1]);
+    auto calendar = JalaliFiscalRegistry::Get(context).Find(name);
+    Function::EraseArgument(bound_function, arguments, 1);
+    return make_uniq<JalaliFiscalBindData>(std::move(calendar), JalaliFiscalPart::PERIOD);
+}
+
+// jalali_fiscal_trunc(part, ts, name)
+static unique_ptr<FunctionData> JalaliFiscalTruncBind(ClientContext &context, ScalarFunction &bound_function,
+                                                      vector<unique_ptr<Expression>> &arguments) {
+    auto part_name =
+        StringUtil::Lower(JalaliFunctions::ConstantStringArgument(context, bound_function.name, *arguments[0]));
+    JalaliFiscalPart part;
+    if (part_name == "period" || part_name == "month") {
+        part = JalaliFiscalPart::PERIOD;
+    } else if (part_name == "quarter") {
+        part = JalaliFiscalPart::QUARTER;
+    } else if (part_name == "year") {
+        part = JalaliFiscalPart::YEAR;
+    } else {
+        throw InvalidInputException("Unsupported fiscal part \"%s\", expected period, quarter or year", part_name);
+    }
+    auto name = JalaliFunctions::ConstantStringArgument(context, bound_function.name, *arguments[2]);
+    auto calendar = JalaliFiscalRegistry::Get(context).Find(name);
+    Function::EraseArgument(bound_function, arguments, 2);
+    Function::EraseArgument(bound_function, arguments, 0);
+    return make_uniq<JalaliFiscalBindData>(std::move(calendar), part);
+}
+
+template <class OP>
+static void JalaliFiscalExecute(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+    auto &bind_data = func_expr.bind_info->Cast<JalaliFiscalBindData>();
+    auto &calendar = *bind_data.calendar;
+
+    UnaryExecutor::ExecuteWithNulls<timestamp_t, typename OP::RESULT_TYPE>(
+        args.data[0], result, args.size(), [&](timestamp_t ts, ValidityMask &mask, idx_t idx) {
+            int32_t days;
+            int64_t micros;
+            JalaliCalendar::SplitTimestamp(ts, days, micros);
+            idx_t index;
+            if (!calendar.Lookup(days, index)) {
+                mask.SetInvalid(idx);
+                return typename OP::RESULT_TYPE();
+            }
+            return OP::Operation(calendar, bind_data.part, index);
+        });
+}
+
+// Fiscal year * 100 + period number, e.g. 140201
+struct JalaliFiscalPeriodOperator {
+    using RESULT_TYPE = int32_t;
+
+    static int32_t Operation(const JalaliFiscalCalendar &calendar, JalaliFiscalPart, idx_t index) {
+        return (JalaliFiscalCalendar::FIRST_YEAR + int32_t(index / JalaliFiscalCalendar::PERIODS_PER_YEAR)) * 100 +
+               int32_t(index % JalaliFiscalCalendar::PERIODS_PER_YEAR) + 1;
+    }
+};
+
+struct JalaliFiscalYearOperator {
+    using RESULT_TYPE = int32_t;
+
+    static int32_t Operation(const JalaliFiscalCalendar &calendar, JalaliFiscalPart, idx_t index) {
+        return JalaliFiscalCalendar::FIRST_YEAR + int32_t(index / JalaliFiscalCalendar::PERIODS_PER_YEAR);
+    }
+};
+
+struct JalaliFiscalTruncOperator {
+    using RESULT_TYPE = timestamp_t;
+
+    static timestamp_t Operation(const JalaliFiscalCalendar &calendar, JalaliFiscalPart part, idx_t index) {
+        if (part == JalaliFiscalPart::QUARTER) {
+            index -= index % 3;
+        } else if (part == JalaliFiscalPart::YEAR) {
+            index -= index % JalaliFiscalCalendar::PERIODS_PER_YEAR;
+        }
+        return JalaliCalendar::MakeTimestamp(calendar.period_starts[index], 0);
+    }
+};
+
+void JalaliFunctions::RegisterFiscalFunctions(DatabaseInstance &instance) {
+    auto create_pragma = PragmaFunction::PragmaCall(
+        "jalali_create_fiscal_calendar", JalaliCreateFiscalCalendarPragma,
+        {LogicalType::VARCHAR, LogicalType::INTEGER, LogicalType::VARCHAR});
+    ExtensionUtil::RegisterFunction(instance, create_pragma);
+    auto drop_pragma = PragmaFunction::PragmaCall("jalali_drop_fiscal_calendar", JalaliDropFiscalCalendarPragma,
+                                                  {LogicalType::VARCHAR});
+    ExtensionUtil::RegisterFunction(instance, drop_pragma);
+
+    ScalarFunction fiscal_period_function("jalali_fiscal_period", {LogicalType::TIMESTAMP, LogicalType::VARCHAR},
+                                          LogicalType::INTEGER, JalaliFiscalExecute<JalaliFiscalPeriodOperator>,
+                                          JalaliFiscalBind);
+    ExtensionUtil::RegisterFunction(instance, fiscal_period_function);
+
+    ScalarFunction fiscal_year_function("jalali_fiscal_year", {LogicalType::TIMESTAMP, LogicalType::VARCHAR},
+                                        LogicalType::INTEGER, JalaliFiscalExecute<JalaliFiscalYearOperator>,
+                                        JalaliFiscalBind);
+    ExtensionUtil::RegisterFunction(instance, fiscal_year_function);
+
+    ScalarFunction fiscal_trunc_function("jalali_fiscal_trunc",
+                                         {LogicalType::VARCHAR, LogicalType::TIMESTAMP, LogicalType::VARCHAR},
+                                         LogicalType::TIMESTAMP, JalaliFiscalExecute<JalaliFiscalTruncOperator>,
+                                         JalaliFiscalTruncBind);
+    ExtensionUtil::RegisterFunction(instance, fiscal_trunc_function);
+}
+
+} // namespace duckdb
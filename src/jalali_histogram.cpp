@@ -0,0 +1,251 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+#include <map>
+
+namespace duckdb {
+
+// Counts per Jalali period. Counts live in a dense array indexed by period id - base while the ids seen span at
+// most MAX_DENSE_SLOTS periods (e.g. ~85 years of months), and move to an ordered map for wider, sparse ranges.
+struct JalaliHistogramState {
+    static constexpr idx_t MAX_DENSE_SLOTS = 1024;
+
+    int32_t base;
+    vector<uint64_t> *dense;
+    std::map<int32_t, uint64_t> *sparse;
+
+    bool IsEmpty() const {
+        return !dense && !sparse;
+    }
+
+    void Add(int32_t period, uint64_t count) {
+        if (sparse) {
+            (*sparse)[period] += count;
+            return;
+        }
+        if (!dense) {
+            dense = new vector<uint64_t>(1, 0);
+            base = period;
+        } else if (!EnsureRange(period, period)) {
+            (*sparse)[period] += count;
+            return;
+        }
+        (*dense)[idx_t(period - base)] += count;
+    }
+
+    // Grow the dense array to cover [low, high]; returns false after switching to the sparse map instead
+    bool EnsureRange(int32_t low, int32_t high) {
+        auto end = base + int32_t(dense->size());
+        if (low >= base && high < end) {
+            return true;
+        }
+        auto new_base = MinValue(low, base);
+        auto new_end = MaxValue(high + 1, end);
+        if (idx_t(int64_t(new_end) - int64_t(new_base)) > MAX_DENSE_SLOTS) {
+            sparse = new std::map<int32_t, uint64_t>();
+            for (idx_t i = 0; i < dense->size(); i++) {
+                if ((*dense)[i] != 0) {
+                    (*sparse)[base + int32_t(i)] = (*dense)[i];
+                }
+            }
+            delete dense;
+            dense = nullptr;
+            return false;
+        }
+        if (new_base < base) {
+            dense->insert(dense->begin(), idx_t(base - new_base), 0);
+            base = new_base;
+        }
+        dense->resize(idx_t(new_end - base), 0);
+        return true;
+    }
+};
+
+struct JalaliHistogramOperation {
+    template <class STATE>
+    static void Initialize(STATE &state) {
+        state.base = 0;
+        state.dense = nullptr;
+        state.sparse = nullptr;
+    }
+
+    template <class STATE>
+    static void Destroy(STATE &state, AggregateInputData &) {
+        delete state.dense;
+        delete state.sparse;
+    }
+
+    static bool IgnoreNull() {
+        return true;
+    }
+};
+
+static void JalaliHistogramUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count,
+                                  Vector &state_vector, idx_t count) {
+    auto period = aggr_input_data.bind_data->Cast<JalaliPeriodBindData>().period;
+
+    UnifiedVectorFormat input_data;
+    UnifiedVectorFormat state_data;
+    inputs[0].ToUnifiedFormat(count, input_data);
+    state_vector.ToUnifiedFormat(count, state_data);
+    auto timestamps = UnifiedVectorFormat::GetData<timestamp_t>(input_data);
+    auto states = UnifiedVectorFormat::GetData<JalaliHistogramState *>(state_data);
+
+    for (idx_t i = 0; i < count; i++) {
+        auto idx = input_data.sel->get_index(i);
+        if (!input_data.validity.RowIsValid(idx)) {
+            continue;
+        }
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(timestamps[idx], days, micros);
+        states[state_data.sel->get_index(i)]->Add(JalaliCalendar::PeriodId(days, period), 1);
+    }
+}
+
+static void JalaliHistogramCombine(Vector &source_vector, Vector &target_vector, AggregateInputData &, idx_t count) {
+    auto sources = FlatVector::GetData<JalaliHistogramState *>(source_vector);
+    auto targets = FlatVector::GetData<JalaliHistogramState *>(target_vector);
+    for (idx_t i = 0; i < count; i++) {
+        auto &source = *sources[i];
+        auto &target = *targets[i];
+        if (source.IsEmpty()) {
+            continue;
+        }
+        if (source.sparse) {
+            for (auto &entry : *source.sparse) {
+                target.Add(entry.first, entry.second);
+            }
+            continue;
+        }
+        // Dense into dense is a plain array add once the target covers the source range
+        auto low = source.base;
+        auto high = source.base + int32_t(source.dense->size()) - 1;
+        if (target.IsEmpty()) {
+            target.base = low;
+            target.dense = new vector<uint64_t>(*source.dense);
+            continue;
+        }
+        if (target.dense && target.EnsureRange(low, high)) {
+            auto offset = idx_t(low - target.base);
+            auto &target_counts = *target.dense;
+            auto &source_counts = *source.dense;
+            for (idx_t k = 0; k < source_counts.size(); k++) {
+                target_counts[offset + k] += source_counts[k];
+            }
+            continue;
+        }
+        for (idx_t k = 0; k < source.dense->size(); k++) {
+            if ((*source.dense)[k] != 0) {
+                target.Add(low + int32_t(k), (*source.dense)[k]);
+            }
+        }
+    }
+}
+
+// Label of a period: 1402, 1402-Q2, 1402-05, or the Jalali date of the day (the first day of the week)
+static string JalaliPeriodLabel(int32_t period_id, JalaliPeriod period) {
+    int32_t jy, jm, jd;
+    JalaliCalendar::FromDays(JalaliCalendar::PeriodStart(period_id, period), jy, jm, jd);
+    char buffer[JalaliFormatter::MAX_LENGTH];
+    switch (period) {
+    case JalaliPeriod::YEAR:
+        snprintf(buffer, sizeof(buffer), "%04d", jy);
+        break;
+    case JalaliPeriod::QUARTER:
+        snprintf(buffer, sizeof(buffer), "%04d-Q%d", jy, (jm - 1) / 3 + 1);
+        break;
+    case JalaliPeriod::MONTH:
+        snprintf(buffer, sizeof(buffer), "%04d-%02d", jy, jm);
+        break;
+    default:
+        snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", jy, jm, jd);
+        break;
+    }
+    return string(buffer);
+}
+
+static void JalaliHistogramFinalize(Vector &state_vector, AggregateInputData &aggr_input_data, Vector &result,
+                                    idx_t count, idx_t offset) {
+    auto period = aggr_input_data.bind_data->Cast<JalaliPeriodBindData>().period;
+
+    UnifiedVectorFormat state_data;
+    state_vector.ToUnifiedFormat(count, state_data);
+    auto states = UnifiedVectorFormat::GetData<JalaliHistogramState *>(state_data);
+
+    // Size the map child once for all states
+    idx_t new_entries = 0;
+    for (idx_t i = 0; i < count; i++) {
+        auto &state = *states[state_data.sel->get_index(i)];
+        if (state.sparse) {
+            new_entries += state.sparse->size();
+        } else if (state.dense) {
+            for (auto value : *state.dense) {
+                new_entries += value != 0;
+            }
+        }
+    }
+    auto old_size = ListVector::GetListSize(result);
+    ListVector::Reserve(result, old_size + new_entries);
+
+    auto &keys = MapVector::GetKeys(result);
+    auto &values = MapVector::GetValues(result);
+    auto key_data = FlatVector::GetData<string_t>(keys);
+    auto value_data = FlatVector::GetData<uint64_t>(values);
+    auto list_entries = FlatVector::GetData<list_entry_t>(result);
+
+    auto position = old_size;
+    for (idx_t i = 0; i < count; i++) {
+        auto &state = *states[state_data.sel->get_index(i)];
+        auto rid = i + offset;
+        if (state.IsEmpty()) {
+            FlatVector::SetNull(result, rid, true);
+            continue;
+        }
+        list_entries[rid].offset = position;
+        if (state.sparse) {
+            for (auto &entry : *state.sparse) {
+                key_data[position] = StringVector::AddString(keys, JalaliPeriodLabel(entry.first, period));
+                value_data[position] = entry.second;
+                position++;
+            }
+        } else {
+            for (idx_t k = 0; k < state.dense->size(); k++) {
+                if ((*state.dense)[k] == 0) {
+                    continue;
+                }
+                auto label = JalaliPeriodLabel(state.base + int32_t(k), period);
+                key_data[position] = StringVector::AddString(keys, label);
+                value_data[position] = (*state.dense)[k];
+                position++;
+            }
+        }
+        list_entries[rid].length = position - list_entries[rid].offset;
+    }
+    ListVector::SetListSize(result, position);
+}
+
+static unique_ptr<FunctionData> JalaliHistogramBind(ClientContext &context, AggregateFunction &function,
+                                                    vector<unique_ptr<Expression>> &arguments) {
+    auto period_name = JalaliFunctions::ConstantStringArgument(context, function.name, *arguments[1]);
+    auto period = JalaliCalendar::ParsePeriod(period_name);
+    Function::EraseArgument(function, arguments, 1);
+    return make_uniq<JalaliPeriodBindData>(period);
+}
+
+void JalaliFunctions::RegisterHistogramFunctions(DatabaseInstance &instance) {
+    using STATE = JalaliHistogramState;
+    using OP = JalaliHistogramOperation;
+    AggregateFunction histogram_function("jalali_histogram", {LogicalType::TIMESTAMP, LogicalType::VARCHAR},
+                                         LogicalType::MAP(LogicalType::VARCHAR, LogicalType::UBIGINT),
+                                         AggregateFunction::StateSize<STATE>,
+                                         AggregateFunction::StateInitialize<STATE, OP>, JalaliHistogramUpdate,
+                                         JalaliHistogramCombine, JalaliHistogramFinalize, nullptr, JalaliHistogramBind,
+                                         AggregateFunction::StateDestroy<STATE, OP>);
+    ExtensionUtil::RegisterFunction(instance, histogram_function);
+}
+
+} // namespace duckdb
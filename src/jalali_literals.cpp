@@ -0,0 +1,60 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/cast/cast_function_set.hpp"
+#include "duckdb/function/cast/default_casts.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+// Typed Jalali literals. SQL already parses J'1402-05-12' as the typed literal CAST('1402-05-12' AS J), so the
+// types J (a Jalali date) and JT (a Jalali timestamp) are TIMESTAMP aliases whose cast from VARCHAR parses the
+// Jalali text. The binder folds the cast of the constant, and the cheap implicit cast to TIMESTAMP leaves a plain
+// TIMESTAMP constant in the plan for filter pushdown.
+template <bool DATE_ONLY>
+static bool VarcharToJalaliLiteralCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
+    bool all_converted = true;
+    UnaryExecutor::ExecuteWithNulls<string_t, timestamp_t>(
+        source, result, count, [&](string_t input, ValidityMask &mask, idx_t idx) {
+            JalaliParts parts;
+            timestamp_t result;
+            if (!JalaliParser::TryParse(input.GetData(), input.GetSize(), parts) ||
+                !JalaliCalendar::IsValid(parts.year, parts.month, parts.day) || (DATE_ONLY && parts.has_time) ||
+                !JalaliCalendar::YearInRange(parts.year) ||
+                !JalaliCalendar::TryMakeTimestamp(JalaliCalendar::ToDays(parts.year, parts.month, parts.day),
+                                                  parts.micros - parts.offset_micros, result)) {
+                auto expected = DATE_ONLY ? "YYYY-MM-DD" : "YYYY-MM-DD[ HH:MM[:SS]]";
+                HandleCastError::AssignError(StringUtil::Format("Invalid Jalali %s literal \"%s\", expected %s",
+                                                                DATE_ONLY ? "date" : "timestamp",
+                                                                input.GetString(), expected),
+                                             parameters);
+                all_converted = false;
+                mask.SetInvalid(idx);
+                return timestamp_t(0);
+            }
+            return result;
+        });
+    return all_converted;
+}
+
+void JalaliFunctions::RegisterLiteralTypes(DatabaseInstance &instance) {
+    auto date_type = LogicalType(LogicalTypeId::TIMESTAMP);
+    date_type.SetAlias("J");
+    auto timestamp_type = LogicalType(LogicalTypeId::TIMESTAMP);
+    timestamp_type.SetAlias("JT");
+    ExtensionUtil::RegisterType(instance, "J", date_type);
+    ExtensionUtil::RegisterType(instance, "JT", timestamp_type);
+
+    ExtensionUtil::RegisterCastFunction(instance, LogicalType::VARCHAR, date_type,
+                                        BoundCastInfo(VarcharToJalaliLiteralCast<true>));
+    ExtensionUtil::RegisterCastFunction(instance, LogicalType::VARCHAR, timestamp_type,
+                                        BoundCastInfo(VarcharToJalaliLiteralCast<false>));
+    // Both are stored as TIMESTAMP, so the cast back is a reinterpretation
+    ExtensionUtil::RegisterCastFunction(instance, date_type, LogicalType::TIMESTAMP,
+                                        BoundCastInfo(DefaultCasts::ReinterpretCast), 1);
+    ExtensionUtil::RegisterCastFunction(instance, timestamp_type, LogicalType::TIMESTAMP,
+                                        BoundCastInfo(DefaultCasts::ReinterpretCast), 1);
+}
+
+} // namespace duckdb
@@ -0,0 +1,254 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/cast/cast_function_set.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
+
+namespace duckdb {
+
+// JALALI_MONTH: a USMALLINT alias holding the month period id jy * 12 + jm - 1 (the same id jalali_period_id
+// returns for 'month'), which covers Jalali years 0 through 5461 in two bytes
+LogicalType JalaliFunctions::JalaliMonthType() {
+    auto type = LogicalType(LogicalTypeId::USMALLINT);
+    type.SetAlias("JALALI_MONTH");
+    return type;
+}
+
+static inline bool JalaliMonthTryFromId(int64_t id, uint16_t &result) {
+    if (id < 0 || id > int64_t(NumericLimits<uint16_t>::Maximum())) {
+        return false;
+    }
+    result = uint16_t(id);
+    return true;
+}
+
+static inline uint16_t JalaliMonthFromId(int64_t id) {
+    uint16_t result;
+    if (!JalaliMonthTryFromId(id, result)) {
+        throw OutOfRangeException("JALALI_MONTH out of range: month id %lld", id);
+    }
+    return result;
+}
+
+static inline bool JalaliMonthTryFromDays(int32_t days, uint16_t &result) {
+    return JalaliMonthTryFromId(JalaliCalendar::PeriodId(days, JalaliPeriod::MONTH), result);
+}
+
+// Parse "YYYY-MM" (the year takes one to four digits), surrounding whitespace allowed
+static bool JalaliMonthTryParse(const char *data, idx_t len, uint16_t &result) {
+    idx_t pos = 0;
+    while (pos < len && JalaliParser::IsSpace(data[pos])) {
+        pos++;
+    }
+    int32_t jy, jm;
+    if (!JalaliParser::ParseNumber(data, len, pos, jy, 4) || pos >= len || data[pos] != '-') {
+        return false;
+    }
+    pos++;
+    if (!JalaliParser::ParseNumber(data, len, pos, jm, 2) || jm < 1 || jm > 12) {
+        return false;
+    }
+    while (pos < len && JalaliParser::IsSpace(data[pos])) {
+        pos++;
+    }
+    return pos == len && JalaliMonthTryFromId(int64_t(jy) * 12 + jm - 1, result);
+}
+
+//===--------------------------------------------------------------------===//
+// Casts
+//===--------------------------------------------------------------------===//
+static bool JalaliMonthCastError(const string &message, CastParameters &parameters, ValidityMask &mask, idx_t idx) {
+    HandleCastError::AssignError(message, parameters);
+    mask.SetInvalid(idx);
+    return false;
+}
+
+static bool VarcharToJalaliMonthCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
+    bool all_converted = true;
+    UnaryExecutor::ExecuteWithNulls<string_t, uint16_t>(
+        source, result, count, [&](string_t input, ValidityMask &mask, idx_t idx) {
+            uint16_t month;
+            if (!JalaliMonthTryParse(input.GetData(), input.GetSize(), month)) {
+                all_converted = JalaliMonthCastError(
+                    StringUtil::Format("Could not convert \"%s\" to JALALI_MONTH, expected YYYY-MM", input.GetString()),
+                    parameters, mask, idx);
+                return uint16_t(0);
+            }
+            return month;
+        });
+    return all_converted;
+}
+
+static bool JalaliMonthToVarcharCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
+    UnaryExecutor::Execute<uint16_t, string_t>(source, result, count, [&](uint16_t month) {
+        char buffer[JalaliFormatter::MAX_LENGTH];
+        auto length = snprintf(buffer, sizeof(buffer), "%04d-%02d", month / 12, month % 12 + 1);
+        return StringVector::AddString(result, buffer, idx_t(length));
+    });
+    return true;
+}
+
+static inline int32_t JalaliMonthDays(date_t input) {
+    return input.days;
+}
+
+static inline int32_t JalaliMonthDays(timestamp_t input) {
+    int32_t days;
+    int64_t micros;
+    JalaliCalendar::SplitTimestamp(input, days, micros);
+    return days;
+}
+
+template <class T>
+static bool ToJalaliMonthCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
+    bool all_converted = true;
+    UnaryExecutor::ExecuteWithNulls<T, uint16_t>(source, result, count, [&](T input, ValidityMask &mask, idx_t idx) {
+        uint16_t month;
+        if (!Value::IsFinite(input) || !JalaliMonthTryFromDays(JalaliMonthDays(input), month)) {
+            all_converted = JalaliMonthCastError("Value is out of range for JALALI_MONTH", parameters, mask, idx);
+            return uint16_t(0);
+        }
+        return month;
+    });
+    return all_converted;
+}
+
+static bool JalaliMonthToDateCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
+    UnaryExecutor::Execute<uint16_t, date_t>(source, result, count, [&](uint16_t month) {
+        return date_t(JalaliCalendar::PeriodStart(month, JalaliPeriod::MONTH));
+    });
+    return true;
+}
+
+static bool JalaliMonthToTimestampCast(Vector &source, Vector &result, idx_t count, CastParameters &parameters) {
+    UnaryExecutor::Execute<uint16_t, timestamp_t>(source, result, count, [&](uint16_t month) {
+        return JalaliCalendar::MakeTimestamp(JalaliCalendar::PeriodStart(month, JalaliPeriod::MONTH), 0);
+    });
+    return true;
+}
+
+//===--------------------------------------------------------------------===//
+// Functions
+//===--------------------------------------------------------------------===//
+static void JalaliMonthScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    UnaryExecutor::Execute<timestamp_t, uint16_t>(args.data[0], result, args.size(), [&](timestamp_t ts) {
+        if (!Value::IsFinite(ts)) {
+            throw OutOfRangeException("JALALI_MONTH out of range: infinite timestamp");
+        }
+        return JalaliMonthFromId(JalaliCalendar::PeriodId(JalaliMonthDays(ts), JalaliPeriod::MONTH));
+    });
+}
+
+// At most 12 months per Jalali year in the input range
+static unique_ptr<BaseStatistics> JalaliMonthStats(ClientContext &context, FunctionStatisticsInput &input) {
+    auto &child_stats = input.child_stats;
+    int32_t min_days, max_days;
+    uint16_t min_month, max_month;
+    if (!JalaliFunctions::TimestampDayRange(child_stats[0], min_days, max_days) ||
+        !JalaliMonthTryFromDays(min_days, min_month) || !JalaliMonthTryFromDays(max_days, max_month)) {
+        return nullptr;
+    }
+    auto result = NumericStats::CreateEmpty(input.expr.return_type);
+    NumericStats::SetMin(result, Value::USMALLINT(min_month));
+    NumericStats::SetMax(result, Value::USMALLINT(max_month));
+    result.CopyValidity(child_stats[0]);
+    result.SetDistinctCount(idx_t(max_month - min_month) + 1);
+    return result.ToUnique();
+}
+
+static void JalaliMonthAddFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    BinaryExecutor::Execute<uint16_t, int32_t, uint16_t>(
+        args.data[0], args.data[1], result, args.size(),
+        [&](uint16_t month, int32_t months) { return JalaliMonthFromId(int64_t(month) + months); });
+}
+
+// Months from start to end, like date_diff('month', start, end)
+static void JalaliMonthDiffFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    BinaryExecutor::Execute<uint16_t, uint16_t, int32_t>(
+        args.data[0], args.data[1], result, args.size(),
+        [&](uint16_t start, uint16_t end) { return int32_t(end) - int32_t(start); });
+}
+
+// The months in [start, end), like range()
+static void JalaliMonthRangeFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    const idx_t count = args.size();
+    UnifiedVectorFormat start_data;
+    UnifiedVectorFormat end_data;
+    args.data[0].ToUnifiedFormat(count, start_data);
+    args.data[1].ToUnifiedFormat(count, end_data);
+    auto starts = UnifiedVectorFormat::GetData<uint16_t>(start_data);
+    auto ends = UnifiedVectorFormat::GetData<uint16_t>(end_data);
+
+    result.SetVectorType(VectorType::FLAT_VECTOR);
+    auto list_entries = FlatVector::GetData<list_entry_t>(result);
+    auto &result_validity = FlatVector::Validity(result);
+
+    idx_t total = 0;
+    for (idx_t i = 0; i < count; i++) {
+        auto start_idx = start_data.sel->get_index(i);
+        auto end_idx = end_data.sel->get_index(i);
+        if (start_data.validity.RowIsValid(start_idx) && end_data.validity.RowIsValid(end_idx) &&
+            ends[end_idx] > starts[start_idx]) {
+            total += idx_t(ends[end_idx] - starts[start_idx]);
+        }
+    }
+    ListVector::Reserve(result, total);
+    auto months = FlatVector::GetData<uint16_t>(ListVector::GetEntry(result));
+
+    idx_t position = 0;
+    for (idx_t i = 0; i < count; i++) {
+        auto start_idx = start_data.sel->get_index(i);
+        auto end_idx = end_data.sel->get_index(i);
+        if (!start_data.validity.RowIsValid(start_idx) || !end_data.validity.RowIsValid(end_idx)) {
+            result_validity.SetInvalid(i);
+            continue;
+        }
+        list_entries[i].offset = position;
+        for (auto month = starts[start_idx]; month < ends[end_idx]; month++) {
+            months[position++] = month;
+        }
+        list_entries[i].length = position - list_entries[i].offset;
+    }
+    ListVector::SetListSize(result, position);
+    if (args.AllConstant()) {
+        result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    }
+}
+
+void JalaliFunctions::RegisterMonthFunctions(DatabaseInstance &instance) {
+    auto month_type = JalaliMonthType();
+    ExtensionUtil::RegisterType(instance, "JALALI_MONTH", month_type);
+
+    ExtensionUtil::RegisterCastFunction(instance, LogicalType::VARCHAR, month_type,
+                                        BoundCastInfo(VarcharToJalaliMonthCast));
+    ExtensionUtil::RegisterCastFunction(instance, month_type, LogicalType::VARCHAR,
+                                        BoundCastInfo(JalaliMonthToVarcharCast));
+    ExtensionUtil::RegisterCastFunction(instance, LogicalType::DATE, month_type,
+                                        BoundCastInfo(ToJalaliMonthCast<date_t>));
+    ExtensionUtil::RegisterCastFunction(instance, LogicalType::TIMESTAMP, month_type,
+                                        BoundCastInfo(ToJalaliMonthCast<timestamp_t>));
+    ExtensionUtil::RegisterCastFunction(instance, month_type, LogicalType::DATE, BoundCastInfo(JalaliMonthToDateCast));
+    ExtensionUtil::RegisterCastFunction(instance, month_type, LogicalType::TIMESTAMP,
+                                        BoundCastInfo(JalaliMonthToTimestampCast));
+
+    ScalarFunction month_function("jalali_month", {LogicalType::TIMESTAMP}, month_type, JalaliMonthScalarFun);
+    month_function.statistics = JalaliMonthStats;
+    ExtensionUtil::RegisterFunction(instance, month_function);
+
+    ScalarFunction add_function("jalali_month_add", {month_type, LogicalType::INTEGER}, month_type,
+                                JalaliMonthAddFun);
+    ExtensionUtil::RegisterFunction(instance, add_function);
+
+    ScalarFunction diff_function("jalali_month_diff", {month_type, month_type}, LogicalType::INTEGER,
+                                 JalaliMonthDiffFun);
+    ExtensionUtil::RegisterFunction(instance, diff_function);
+
+    ScalarFunction range_function("jalali_month_range", {month_type, month_type}, LogicalType::LIST(month_type),
+                                  JalaliMonthRangeFun);
+    ExtensionUtil::RegisterFunction(instance, range_function);
+}
+
+} // namespace duckdb
@@ -0,0 +1,206 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/common/types/decimal.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/function_set.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
+
+namespace duckdb {
+
+Value JalaliFunctions::ConstantArgument(ClientContext &context, const string &function_name, Expression &argument) {
+    if (argument.HasParameter() || !argument.IsFoldable()) {
+        throw BinderException("%s: the %s argument must be a constant", function_name, argument.GetName());
+    }
+    auto value = ExpressionExecutor::EvaluateScalar(context, argument);
+    if (value.IsNull()) {
+        throw BinderException("%s: the %s argument cannot be NULL", function_name, argument.GetName());
+    }
+    return value;
+}
+
+string JalaliFunctions::ConstantStringArgument(ClientContext &context, const string &function_name,
+                                              Expression &argument) {
+    return ConstantArgument(context, function_name, argument).GetValue<string>();
+}
+
+bool JalaliFunctions::TimestampDayRange(const BaseStatistics &stats, int32_t &min_days, int32_t &max_days) {
+    if (!NumericStats::HasMinMax(stats)) {
+        return false;
+    }
+    auto min_ts = NumericStats::GetMin<timestamp_t>(stats);
+    auto max_ts = NumericStats::GetMax<timestamp_t>(stats);
+    if (!Value::IsFinite(min_ts) || !Value::IsFinite(max_ts)) {
+        return false;
+    }
+    int64_t micros;
+    JalaliCalendar::SplitTimestamp(min_ts, min_days, micros);
+    JalaliCalendar::SplitTimestamp(max_ts, max_days, micros);
+    return true;
+}
+
+unique_ptr<FunctionData> JalaliFunctions::BindPeriodArgument(ClientContext &context, ScalarFunction &bound_function,
+                                                             vector<unique_ptr<Expression>> &arguments) {
+    auto period_name = JalaliFunctions::ConstantStringArgument(context, bound_function.name, *arguments[1]);
+    auto period = JalaliCalendar::ParsePeriod(period_name);
+    Function::EraseArgument(bound_function, arguments, 1);
+    return make_uniq<JalaliPeriodBindData>(period);
+}
+
+// Scalar function returning the sequential Jalali period id of a timestamp
+static void JalaliPeriodIdScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+    auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+    auto period = func_expr.bind_info->Cast<JalaliPeriodBindData>().period;
+
+    UnaryExecutor::Execute<timestamp_t, int32_t>(args.data[0], result, args.size(), [&](timestamp_t ts) {
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(ts, days, micros);
+        return JalaliCalendar::PeriodId(days, period);
+    });
+}
+
+// Running "period-to-date" sum: the sum of the values whose timestamp falls in the same Jalali period as the
+// latest timestamp seen. Used as a window aggregate ordered by time, e.g.
+// jalali_mtd_sum(amount, ts) OVER (ORDER BY ts), it restarts at every period boundary without repartitioning.
+template <class T>
+struct JalaliToDateState {
+    using SUM_TYPE = T;
+
+    bool is_set;
+    int32_t period;
+    T sum;
+};
+
+template <JalaliPeriod PERIOD>
+struct JalaliToDateSumOperation {
+    template <class STATE>
+    static void Initialize(STATE &state) {
+        state.is_set = false;
+        state.period = 0;
+        state.sum = typename STATE::SUM_TYPE(0);
+    }
+
+    template <class A_TYPE, class B_TYPE, class STATE, class OP>
+    static void Operation(STATE &state, const A_TYPE &value, const B_TYPE &ts, AggregateBinaryInput &) {
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(ts, days, micros);
+        auto period = JalaliCalendar::PeriodId(days, PERIOD);
+        if (!state.is_set || period > state.period) {
+            state.is_set = true;
+            state.period = period;
+            state.sum = typename STATE::SUM_TYPE(value);
+        } else if (period == state.period) {
+            state.sum += typename STATE::SUM_TYPE(value);
+        }
+    }
+
+    template <class STATE, class OP>
+    static void Combine(const STATE &source, STATE &target, AggregateInputData &) {
+        if (!source.is_set) {
+            return;
+        }
+        if (!target.is_set || source.period > target.period) {
+            target = source;
+        } else if (source.period == target.period) {
+            target.sum += source.sum;
+        }
+    }
+
+    template <class T, class STATE>
+    static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+        if (!state.is_set) {
+            finalize_data.ReturnNull();
+        } else {
+            target = state.sum;
+        }
+    }
+
+    static bool IgnoreNull() {
+        return true;
+    }
+};
+
+// DECIMAL amounts are summed exactly as HUGEINT, like sum(), whatever the physical type of the input
+template <JalaliPeriod PERIOD, class INPUT_TYPE>
+static AggregateFunction GetToDateDecimalFunction(const LogicalType &input_type) {
+    using OP = JalaliToDateSumOperation<PERIOD>;
+    return AggregateFunction::BinaryAggregate<JalaliToDateState<hugeint_t>, INPUT_TYPE, timestamp_t, hugeint_t, OP>(
+        input_type, LogicalType::TIMESTAMP, LogicalType::HUGEINT);
+}
+
+template <JalaliPeriod PERIOD>
+static unique_ptr<FunctionData> JalaliToDateDecimalBind(ClientContext &context, AggregateFunction &function,
+                                                        vector<unique_ptr<Expression>> &arguments) {
+    auto decimal_type = arguments[0]->return_type;
+    auto name = function.name;
+    switch (decimal_type.InternalType()) {
+    case PhysicalType::INT16:
+        function = GetToDateDecimalFunction<PERIOD, int16_t>(decimal_type);
+        break;
+    case PhysicalType::INT32:
+        function = GetToDateDecimalFunction<PERIOD, int32_t>(decimal_type);
+        break;
+    case PhysicalType::INT64:
+        function = GetToDateDecimalFunction<PERIOD, int64_t>(decimal_type);
+        break;
+    default:
+        function = GetToDateDecimalFunction<PERIOD, hugeint_t>(decimal_type);
+        break;
+    }
+    function.name = name;
+    function.return_type = LogicalType::DECIMAL(Decimal::MAX_WIDTH_DECIMAL, DecimalType::GetScale(decimal_type));
+    return nullptr;
+}
+
+template <JalaliPeriod PERIOD>
+static AggregateFunctionSet GetToDateSumFunction(const string &name) {
+    using OP = JalaliToDateSumOperation<PERIOD>;
+    AggregateFunctionSet set(name);
+    set.AddFunction(AggregateFunction::BinaryAggregate<JalaliToDateState<double>, double, timestamp_t, double, OP>(
+        LogicalType::DOUBLE, LogicalType::TIMESTAMP, LogicalType::DOUBLE));
+    set.AddFunction(
+        AggregateFunction::BinaryAggregate<JalaliToDateState<hugeint_t>, int64_t, timestamp_t, hugeint_t, OP>(
+            LogicalType::BIGINT, LogicalType::TIMESTAMP, LogicalType::HUGEINT));
+    set.AddFunction(AggregateFunction({LogicalTypeId::DECIMAL, LogicalType::TIMESTAMP}, LogicalTypeId::DECIMAL, nullptr,
+                                      nullptr, nullptr, nullptr, nullptr, FunctionNullHandling::DEFAULT_NULL_HANDLING,
+                                      nullptr, JalaliToDateDecimalBind<PERIOD>));
+    return set;
+}
+
+// Period ids grow with time, so the ids of the input's min and max bound the result and its distinct count
+static unique_ptr<BaseStatistics> JalaliPeriodIdStats(ClientContext &context, FunctionStatisticsInput &input) {
+    auto &child_stats = input.child_stats;
+    auto period = input.bind_data->Cast<JalaliPeriodBindData>().period;
+    int32_t min_days, max_days;
+    if (!JalaliFunctions::TimestampDayRange(child_stats[0], min_days, max_days)) {
+        return nullptr;
+    }
+    auto min_id = JalaliCalendar::PeriodId(min_days, period);
+    auto max_id = JalaliCalendar::PeriodId(max_days, period);
+    auto result = NumericStats::CreateEmpty(input.expr.return_type);
+    NumericStats::SetMin(result, Value::INTEGER(min_id));
+    NumericStats::SetMax(result, Value::INTEGER(max_id));
+    result.CopyValidity(child_stats[0]);
+    result.SetDistinctCount(idx_t(int64_t(max_id) - int64_t(min_id)) + 1);
+    return result.ToUnique();
+}
+
+void JalaliFunctions::RegisterPeriodFunctions(DatabaseInstance &instance) {
+    ScalarFunction period_id_function("jalali_period_id", {LogicalType::TIMESTAMP, LogicalType::VARCHAR},
+                                      LogicalType::INTEGER, JalaliPeriodIdScalarFun,
+                                      JalaliFunctions::BindPeriodArgument);
+    period_id_function.statistics = JalaliPeriodIdStats;
+    ExtensionUtil::RegisterFunction(instance, period_id_function);
+
+    ExtensionUtil::RegisterFunction(instance, GetToDateSumFunction<JalaliPeriod::YEAR>("jalali_ytd_sum"));
+    ExtensionUtil::RegisterFunction(instance, GetToDateSumFunction<JalaliPeriod::QUARTER>("jalali_qtd_sum"));
+    ExtensionUtil::RegisterFunction(instance, GetToDateSumFunction<JalaliPeriod::MONTH>("jalali_mtd_sum"));
+    ExtensionUtil::RegisterFunction(instance, GetToDateSumFunction<JalaliPeriod::WEEK>("jalali_wtd_sum"));
+}
+
+} // namespace duckdb
@@ -0,0 +1,854 @@
+#include "jalali_functions.hpp"
+#include "jalali_calendar.hpp"
+#include "duckdb/common/types/decimal.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+#include <map>
+#include <set>
+
+namespace duckdb {
+
+// Resolve the key column of an in-out function's input table: the named column, or the first one
+static idx_t JalaliBindKeyColumn(TableFunctionBindInput &input, const string &function_name) {
+    idx_t key_index = 0;
+    auto entry = input.named_parameters.find("key");
+    if (entry != input.named_parameters.end()) {
+        auto key_name = entry->second.GetValue<string>();
+        key_index = DConstants::INVALID_INDEX;
+        for (idx_t i = 0; i < input.input_table_names.size(); i++) {
+            if (StringUtil::CIEquals(input.input_table_names[i], key_name)) {
+                key_index = i;
+                break;
+            }
+        }
+        if (key_index == DConstants::INVALID_INDEX) {
+            throw BinderException("%s: key column \"%s\" not found in the input", function_name, key_name);
+        }
+    }
+    if (key_index >= input.input_table_types.size()) {
+        throw BinderException("%s: the input table needs at least one column", function_name);
+    }
+    switch (input.input_table_types[key_index].id()) {
+    case LogicalTypeId::TIMESTAMP:
+    case LogicalTypeId::DATE:
+    case LogicalTypeId::INTEGER:
+        break;
+    default:
+        throw BinderException("%s: the key column must be a TIMESTAMP, DATE or INTEGER Jalali period id, not %s",
+                              function_name, input.input_table_types[key_index].ToString());
+    }
+    return key_index;
+}
+
+static JalaliPeriod JalaliBindPeriodParameter(TableFunctionBindInput &input) {
+    auto entry = input.named_parameters.find("period");
+    if (entry == input.named_parameters.end() || entry->second.IsNull()) {
+        return JalaliPeriod::MONTH;
+    }
+    return JalaliCalendar::ParsePeriod(entry->second.GetValue<string>());
+}
+
+// Period id of a key value; INTEGER keys are already period ids (see jalali_period_id)
+static inline int32_t JalaliKeyToPeriod(const UnifiedVectorFormat &key_data, const LogicalType &key_type, idx_t idx,
+                                        JalaliPeriod period) {
+    switch (key_type.id()) {
+    case LogicalTypeId::TIMESTAMP: {
+        int32_t days;
+        int64_t micros;
+        JalaliCalendar::SplitTimestamp(UnifiedVectorFormat::GetData<timestamp_t>(key_data)[idx], days, micros);
+        return JalaliCalendar::PeriodId(days, period);
+    }
+    case LogicalTypeId::DATE:
+        return JalaliCalendar::PeriodId(UnifiedVectorFormat::GetData<date_t>(key_data)[idx].days, period);
+    default:
+        return UnifiedVectorFormat::GetData<int32_t>(key_data)[idx];
+    }
+}
+
+// Write the key value that represents the start of a period
+static inline void JalaliWritePeriodKey(Vector &key_vector, idx_t row, int32_t period_id, JalaliPeriod period) {
+    switch (key_vector.GetType().id()) {
+    case LogicalTypeId::TIMESTAMP:
+        FlatVector::GetData<timestamp_t>(key_vector)[row] =
+            JalaliCalendar::MakeTimestamp(JalaliCalendar::PeriodStart(period_id, period), 0);
+        break;
+    case LogicalTypeId::DATE:
+        FlatVector::GetData<date_t>(key_vector)[row] = date_t(JalaliCalendar::PeriodStart(period_id, period));
+        break;
+    default:
+        FlatVector::GetData<int32_t>(key_vector)[row] = period_id;
+        break;
+    }
+    FlatVector::Validity(key_vector).SetValid(row);
+}
+
+// Shared state of the parallel streams of an in-out function over key-sorted input. DuckDB runs in-out functions
+// on several threads and hands each one a subset of the input chunks, so a stream cannot carry a period over from
+// one chunk to the next: each chunk settles the periods strictly inside its own range, while its first and last
+// period may continue in other chunks. The source hands out chunks in input order, so a chunk that a stream has
+// not processed yet starts no earlier than the last period of that stream's latest chunk. Every period before the
+// smallest of these marks is final, and the stream that advances the smallest mark emits what it settles.
+struct JalaliStreamGlobalState : public GlobalTableFunctionState {
+    mutex lock;
+    idx_t next_stream = 0;
+    // Streams that have started but not finished, and those of them without a mark yet: their first chunk may
+    // start anywhere, so nothing is settled while there are any
+    idx_t active_streams = 0;
+    idx_t unmarked_streams = 0;
+    // Last period of the latest chunk of each marked stream
+    std::map<idx_t, int32_t> stream_marks;
+    // Periods before `settled` are final
+    int64_t settled = NumericLimits<int64_t>::Minimum();
+    // Distinct [first, last] period ranges of the chunks that are not settled yet, plus the last settled one.
+    // Chunks of a sorted input share at most an end period, so ordered by their first period the ranges also have
+    // ascending last periods.
+    std::set<std::pair<int32_t, int32_t>> ranges;
+
+    idx_t StartStream() {
+        lock_guard<mutex> guard(lock);
+        active_streams++;
+        unmarked_streams++;
+        return next_stream++;
+    }
+
+    // With the lock held
+    void FinishStream(idx_t stream) {
+        if (stream_marks.erase(stream) == 0) {
+            unmarked_streams--;
+        }
+        active_streams--;
+    }
+
+    // With the lock held: record the period range of a chunk of `stream`. A range that starts among the settled
+    // periods or overlaps another chunk's range by more than an end period means the input is not sorted.
+    void AddChunk(const string &function_name, idx_t stream, int32_t first, int32_t last) {
+        auto next = ranges.lower_bound(std::make_pair(last, NumericLimits<int32_t>::Minimum()));
+        if (first < settled || (next != ranges.begin() && std::prev(next)->second > first)) {
+            throw InvalidInputException("%s: the input must be sorted on the key column", function_name);
+        }
+        ranges.emplace(first, last);
+        if (stream_marks.find(stream) == stream_marks.end()) {
+            unmarked_streams--;
+        }
+        stream_marks[stream] = last;
+    }
+
+    // With the lock held: advance `settled` to the smallest mark, or past every period once all streams have
+    // finished, and drop the ranges that are followed by a settled one. The gaps between consecutive dropped ranges
+    // are appended to `gaps` when given.
+    void Settle(vector<std::pair<int32_t, int32_t>> *gaps) {
+        if (active_streams > 0 && unmarked_streams > 0) {
+            return;
+        }
+        int64_t bound = NumericLimits<int64_t>::Maximum();
+        for (auto &mark : stream_marks) {
+            bound = MinValue<int64_t>(bound, mark.second);
+        }
+        while (ranges.size() >= 2) {
+            auto first = ranges.begin();
+            auto second = std::next(first);
+            if (second->first > bound) {
+                break;
+            }
+            if (gaps && first->second + 1 < second->first) {
+                gaps->emplace_back(first->second + 1, second->first - 1);
+            }
+            ranges.erase(first);
+        }
+        settled = MaxValue(settled, bound);
+    }
+};
+
+static unique_ptr<GlobalTableFunctionState> JalaliStreamInitGlobal(ClientContext &context,
+                                                                   TableFunctionInitInput &input) {
+    return make_uniq<JalaliStreamGlobalState>();
+}
+
+//===--------------------------------------------------------------------===//
+// jalali_fill_gaps
+//===--------------------------------------------------------------------===//
+struct JalaliFillGapsBindData : public TableFunctionData {
+    idx_t key_index;
+    JalaliPeriod period;
+    // Values of the other columns in gap rows: the default for numeric columns, NULL otherwise
+    vector<Value> gap_values;
+};
+
+// Gap filling state of one input stream. Gaps are filled between consecutive rows of a chunk as they arrive, so
+// the input has to be sorted on the key; gaps between chunks are filled by the stream that settles them.
+struct JalaliFillGapsLocalState : public LocalTableFunctionState {
+    idx_t stream = 0;
+    bool has_last = false;
+    int32_t first_period = 0;
+    int32_t last_period = 0;
+    // Next input row to process when the previous call ran out of output space
+    idx_t input_offset = 0;
+    idx_t gap_rows[STANDARD_VECTOR_SIZE];
+    int32_t gap_periods[STANDARD_VECTOR_SIZE];
+    // Settled gaps between chunks, as inclusive period ranges, left to emit
+    vector<std::pair<int32_t, int32_t>> chunk_gaps;
+    idx_t chunk_gap_index = 0;
+    bool finished = false;
+};
+
+static unique_ptr<FunctionData> JalaliFillGapsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<JalaliFillGapsBindData>();
+    result->key_index = JalaliBindKeyColumn(input, "jalali_fill_gaps");
+    result->period = JalaliBindPeriodParameter(input);
+    Value default_value;
+    auto entry = input.named_parameters.find("default");
+    if (entry != input.named_parameters.end()) {
+        default_value = entry->second;
+    }
+    for (idx_t col = 0; col < input.input_table_types.size(); col++) {
+        auto &type = input.input_table_types[col];
+        if (col != result->key_index && !default_value.IsNull() && type.IsNumeric()) {
+            result->gap_values.push_back(default_value.DefaultCastAs(type));
+        } else {
+            result->gap_values.push_back(Value(type));
+        }
+    }
+    return_types = input.input_table_types;
+    names = input.input_table_names;
+    return std::move(result);
+}
+
+static unique_ptr<LocalTableFunctionState> JalaliFillGapsInitLocal(ExecutionContext &context,
+                                                                   TableFunctionInitInput &input,
+                                                                   GlobalTableFunctionState *global_state) {
+    auto result = make_uniq<JalaliFillGapsLocalState>();
+    result->stream = global_state->Cast<JalaliStreamGlobalState>().StartStream();
+    return std::move(result);
+}
+
+// Write the gap row of period_id as output row `row`
+static void JalaliFillGapsWriteGap(const JalaliFillGapsBindData &bind_data, DataChunk &output, idx_t row,
+                                   int32_t period_id) {
+    for (idx_t col = 0; col < output.ColumnCount(); col++) {
+        if (col == bind_data.key_index) {
+            JalaliWritePeriodKey(output.data[col], row, period_id, bind_data.period);
+        } else {
+            output.data[col].SetValue(row, bind_data.gap_values[col]);
+        }
+    }
+}
+
+// Append the settled gaps between chunks after the first out_count output rows; returns the new row count
+static idx_t JalaliFillGapsEmitChunkGaps(const JalaliFillGapsBindData &bind_data, JalaliFillGapsLocalState &lstate,
+                                         DataChunk &output, idx_t out_count) {
+    while (lstate.chunk_gap_index < lstate.chunk_gaps.size() && out_count < STANDARD_VECTOR_SIZE) {
+        auto &gap = lstate.chunk_gaps[lstate.chunk_gap_index];
+        JalaliFillGapsWriteGap(bind_data, output, out_count++, gap.first);
+        if (gap.first++ == gap.second) {
+            lstate.chunk_gap_index++;
+        }
+    }
+    if (lstate.chunk_gap_index == lstate.chunk_gaps.size()) {
+        lstate.chunk_gaps.clear();
+        lstate.chunk_gap_index = 0;
+    }
+    return out_count;
+}
+
+static OperatorResultType JalaliFillGapsFunction(ExecutionContext &context, TableFunctionInput &data,
+                                                 DataChunk &input, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<JalaliFillGapsBindData>();
+    auto &lstate = data.local_state->Cast<JalaliFillGapsLocalState>();
+    if (!lstate.chunk_gaps.empty()) {
+        // The input chunk is done; the gaps it settled did not all fit in the previous output
+        output.SetCardinality(JalaliFillGapsEmitChunkGaps(bind_data, lstate, output, 0));
+        return lstate.chunk_gaps.empty() ? OperatorResultType::NEED_MORE_INPUT : OperatorResultType::HAVE_MORE_OUTPUT;
+    }
+    auto &key_vector = input.data[bind_data.key_index];
+    auto &key_type = key_vector.GetType();
+    // Periods are not carried over from the previous chunk: the chunks in between may go to other streams
+    if (lstate.input_offset == 0) {
+        lstate.has_last = false;
+    }
+
+    UnifiedVectorFormat key_data;
+    key_vector.ToUnifiedFormat(input.size(), key_data);
+
+    // Map every output row to an input row; gap rows borrow the row that follows them and are patched below
+    SelectionVector sel(STANDARD_VECTOR_SIZE);
+    idx_t out_count = 0;
+    idx_t gap_count = 0;
+    idx_t row = lstate.input_offset;
+    while (row < input.size()) {
+        auto idx = key_data.sel->get_index(row);
+        if (key_data.validity.RowIsValid(idx)) {
+            auto period = JalaliKeyToPeriod(key_data, key_type, idx, bind_data.period);
+            if (lstate.has_last && period < lstate.last_period) {
+                throw InvalidInputException("jalali_fill_gaps: the input must be sorted on the key column");
+            }
+            while (lstate.has_last && lstate.last_period + 1 < period && out_count < STANDARD_VECTOR_SIZE) {
+                lstate.last_period++;
+                lstate.gap_rows[gap_count] = out_count;
+                lstate.gap_periods[gap_count] = lstate.last_period;
+                gap_count++;
+                sel.set_index(out_count++, row);
+            }
+            if (out_count == STANDARD_VECTOR_SIZE) {
+                break;
+            }
+            if (!lstate.has_last) {
+                lstate.has_last = true;
+                lstate.first_period = period;
+            }
+            lstate.last_period = period;
+        } else if (out_count == STANDARD_VECTOR_SIZE) {
+            break;
+        }
+        sel.set_index(out_count++, row);
+        row++;
+    }
+
+    for (idx_t col = 0; col < output.ColumnCount(); col++) {
+        VectorOperations::Copy(input.data[col], output.data[col], sel, out_count, 0, 0);
+    }
+    for (idx_t g = 0; g < gap_count; g++) {
+        JalaliFillGapsWriteGap(bind_data, output, lstate.gap_rows[g], lstate.gap_periods[g]);
+    }
+
+    if (row < input.size()) {
+        output.SetCardinality(out_count);
+        lstate.input_offset = row;
+        return OperatorResultType::HAVE_MORE_OUTPUT;
+    }
+    lstate.input_offset = 0;
+    if (lstate.has_last) {
+        auto &gstate = data.global_state->Cast<JalaliStreamGlobalState>();
+        lock_guard<mutex> guard(gstate.lock);
+        gstate.AddChunk("jalali_fill_gaps", lstate.stream, lstate.first_period, lstate.last_period);
+        gstate.Settle(&lstate.chunk_gaps);
+    }
+    output.SetCardinality(JalaliFillGapsEmitChunkGaps(bind_data, lstate, output, out_count));
+    return lstate.chunk_gaps.empty() ? OperatorResultType::NEED_MORE_INPUT : OperatorResultType::HAVE_MORE_OUTPUT;
+}
+
+// A finishing stream no longer holds periods back: it fills the gaps that this settles, and the last stream to
+// finish fills all remaining ones
+static OperatorFinalizeResultType JalaliFillGapsFinal(ExecutionContext &context, TableFunctionInput &data,
+                                                      DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<JalaliFillGapsBindData>();
+    auto &lstate = data.local_state->Cast<JalaliFillGapsLocalState>();
+    if (!lstate.finished) {
+        lstate.finished = true;
+        auto &gstate = data.global_state->Cast<JalaliStreamGlobalState>();
+        lock_guard<mutex> guard(gstate.lock);
+        gstate.FinishStream(lstate.stream);
+        gstate.Settle(&lstate.chunk_gaps);
+    }
+    output.SetCardinality(JalaliFillGapsEmitChunkGaps(bind_data, lstate, output, 0));
+    return lstate.chunk_gaps.empty() ? OperatorFinalizeResultType::FINISHED
+                                     : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+}
+
+//===--------------------------------------------------------------------===//
+// jalali_resample
+//===--------------------------------------------------------------------===//
+enum class JalaliResampleAgg : uint8_t { COUNT, SUM, MIN, MAX, AVG, FIRST, LAST };
+
+static JalaliResampleAgg JalaliParseResampleAgg(const string &lower) {
+    if (lower == "count") {
+        return JalaliResampleAgg::COUNT;
+    } else if (lower == "sum") {
+        return JalaliResampleAgg::SUM;
+    } else if (lower == "min") {
+        return JalaliResampleAgg::MIN;
+    } else if (lower == "max") {
+        return JalaliResampleAgg::MAX;
+    } else if (lower == "avg") {
+        return JalaliResampleAgg::AVG;
+    } else if (lower == "first") {
+        return JalaliResampleAgg::FIRST;
+    } else if (lower == "last") {
+        return JalaliResampleAgg::LAST;
+    }
+    throw BinderException(
+        "jalali_resample: unsupported aggregate \"%s\", expected count, sum, min, max, avg, first or last", lower);
+}
+
+struct JalaliResampleBindData : public TableFunctionData {
+    idx_t key_index;
+    JalaliPeriod period;
+    // Input columns that are aggregated, and the aggregates applied to each of them
+    vector<idx_t> value_columns;
+    vector<JalaliResampleAgg> aggs;
+    // Result type of the sums of each value column; integer and DECIMAL columns are summed exactly when asked for
+    vector<LogicalType> sum_types;
+    vector<bool> exact_sums;
+};
+
+// Like sum(): HUGEINT for integers, DECIMAL(38, s) for DECIMAL(w, s), DOUBLE for everything else
+static LogicalType JalaliResampleSumType(const LogicalType &type) {
+    switch (type.id()) {
+    case LogicalTypeId::DECIMAL:
+        return LogicalType::DECIMAL(Decimal::MAX_WIDTH_DECIMAL, DecimalType::GetScale(type));
+    case LogicalTypeId::FLOAT:
+    case LogicalTypeId::DOUBLE:
+    case LogicalTypeId::UHUGEINT:
+        return LogicalType::DOUBLE;
+    default:
+        return LogicalType::HUGEINT;
+    }
+}
+
+// Running aggregates of one value column over the open period
+struct JalaliResampleAccumulator {
+    idx_t count;
+    double sum;
+    // Sum of an exactly summed column, as HUGEINT or the unscaled DECIMAL(38, s) value
+    hugeint_t exact_sum;
+    double min;
+    double max;
+    double first;
+    double last;
+    // Keys of the first and last value (timestamp micros, day number or period id), to combine parts of a period
+    int64_t first_position;
+    int64_t last_position;
+
+    void Reset() {
+        count = 0;
+        sum = 0;
+        exact_sum = hugeint_t(0);
+    }
+
+    void AddExact(hugeint_t value) {
+        if (!TryAddOperator::Operation<hugeint_t, hugeint_t, hugeint_t>(exact_sum, value, exact_sum)) {
+            throw OutOfRangeException("jalali_resample: sum is out of range");
+        }
+    }
+
+    void Update(double value, int64_t position) {
+        if (count == 0) {
+            min = max = first = value;
+            first_position = position;
+        } else {
+            min = MinValue(min, value);
+            max = MaxValue(max, value);
+        }
+        last = value;
+        last_position = position;
+        sum += value;
+        count++;
+    }
+
+    // Add the part of the same period seen by another chunk; values with equal keys have no defined order
+    void Combine(const JalaliResampleAccumulator &other) {
+        if (other.count == 0) {
+            return;
+        }
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        min = MinValue(min, other.min);
+        max = MaxValue(max, other.max);
+        if (other.first_position < first_position) {
+            first = other.first;
+            first_position = other.first_position;
+        }
+        if (other.last_position > last_position) {
+            last = other.last;
+            last_position = other.last_position;
+        }
+        sum += other.sum;
+        AddExact(other.exact_sum);
+        count += other.count;
+    }
+};
+
+using JalaliResamplePeriods = vector<std::pair<int32_t, vector<JalaliResampleAccumulator>>>;
+
+// The first and last period of the chunks, combined across the chunks that share them until they are settled
+struct JalaliResampleGlobalState : public JalaliStreamGlobalState {
+    std::map<int32_t, vector<JalaliResampleAccumulator>> boundary_periods;
+
+    // With the lock held
+    void Merge(int32_t period_id, const vector<JalaliResampleAccumulator> &accumulators) {
+        auto entry = boundary_periods.find(period_id);
+        if (entry == boundary_periods.end()) {
+            boundary_periods.emplace(period_id, accumulators);
+            return;
+        }
+        for (idx_t v = 0; v < accumulators.size(); v++) {
+            entry->second[v].Combine(accumulators[v]);
+        }
+    }
+
+    // With the lock held: move the settled boundary periods to `target`, in period order
+    void TakeSettled(JalaliResamplePeriods &target) {
+        auto end = boundary_periods.end();
+        if (settled <= NumericLimits<int32_t>::Maximum()) {
+            end = boundary_periods.lower_bound(int32_t(MaxValue<int64_t>(settled, NumericLimits<int32_t>::Minimum())));
+        }
+        for (auto entry = boundary_periods.begin(); entry != end; entry++) {
+            target.emplace_back(entry->first, std::move(entry->second));
+        }
+        boundary_periods.erase(boundary_periods.begin(), end);
+    }
+};
+
+// Aggregation state of one input stream. The input has to be sorted on the key: a period is closed as soon as a
+// row of a later period arrives, and the two end periods of each chunk are combined in the global state until they
+// are settled. A chunk's output lists the boundary periods it settles before the periods it closed itself, so a
+// single stream produces its periods in order.
+struct JalaliResampleLocalState : public LocalTableFunctionState {
+    idx_t stream = 0;
+    bool has_period = false;
+    int32_t period_id = 0;
+    // Day range [period_begin, period_end) of the open period, to skip the period lookup for rows inside it
+    int32_t period_begin = 0;
+    int32_t period_end = 0;
+    vector<JalaliResampleAccumulator> accumulators;
+    // The first period of the current chunk, kept aside once closed because it may continue in another chunk
+    int32_t first_period = 0;
+    bool first_closed = false;
+    vector<JalaliResampleAccumulator> first_accumulators;
+    // The value columns of the current input chunk as DOUBLE, and as their sum type for exact sums
+    DataChunk values;
+    DataChunk exact_values;
+    // Output left to emit for the current chunk: settled boundary periods, then the periods closed in the chunk
+    JalaliResamplePeriods settled_periods;
+    idx_t settled_index = 0;
+    DataChunk closed;
+    idx_t closed_offset = 0;
+    bool finished = false;
+};
+
+static unique_ptr<FunctionData> JalaliResampleBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<JalaliResampleBindData>();
+    result->key_index = JalaliBindKeyColumn(input, "jalali_resample");
+    result->period = JalaliBindPeriodParameter(input);
+
+    vector<string> agg_names {"count", "sum"};
+    auto entry = input.named_parameters.find("aggs");
+    if (entry != input.named_parameters.end() && !entry->second.IsNull()) {
+        agg_names.clear();
+        for (auto &agg : ListValue::GetChildren(entry->second)) {
+            if (agg.IsNull()) {
+                throw BinderException("jalali_resample: aggregate names cannot be NULL");
+            }
+            agg_names.push_back(StringUtil::Lower(agg.GetValue<string>()));
+        }
+        if (agg_names.empty()) {
+            throw BinderException("jalali_resample: aggs needs at least one aggregate");
+        }
+    }
+    bool has_sum = false;
+    for (auto &agg_name : agg_names) {
+        result->aggs.push_back(JalaliParseResampleAgg(agg_name));
+        has_sum = has_sum || result->aggs.back() == JalaliResampleAgg::SUM;
+    }
+
+    return_types.push_back(input.input_table_types[result->key_index]);
+    names.push_back(input.input_table_names[result->key_index]);
+    for (idx_t col = 0; col < input.input_table_types.size(); col++) {
+        if (col == result->key_index) {
+            continue;
+        }
+        auto &type = input.input_table_types[col];
+        if (!type.IsNumeric()) {
+            throw BinderException("jalali_resample: value column \"%s\" must be numeric, not %s",
+                                  input.input_table_names[col], type.ToString());
+        }
+        result->value_columns.push_back(col);
+        result->sum_types.push_back(JalaliResampleSumType(type));
+        result->exact_sums.push_back(has_sum && result->sum_types.back().id() != LogicalTypeId::DOUBLE);
+        for (idx_t a = 0; a < result->aggs.size(); a++) {
+            switch (result->aggs[a]) {
+            case JalaliResampleAgg::COUNT:
+                return_types.push_back(LogicalType::BIGINT);
+                break;
+            case JalaliResampleAgg::SUM:
+                return_types.push_back(result->sum_types.back());
+                break;
+            default:
+                return_types.push_back(LogicalType::DOUBLE);
+                break;
+            }
+            names.push_back(agg_names[a] + "_" + input.input_table_names[col]);
+        }
+    }
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> JalaliResampleInitGlobal(ClientContext &context,
+                                                                     TableFunctionInitInput &input) {
+    return make_uniq<JalaliResampleGlobalState>();
+}
+
+static unique_ptr<LocalTableFunctionState> JalaliResampleInitLocal(ExecutionContext &context,
+                                                                   TableFunctionInitInput &input,
+                                                                   GlobalTableFunctionState *global_state) {
+    auto &bind_data = input.bind_data->Cast<JalaliResampleBindData>();
+    auto result = make_uniq<JalaliResampleLocalState>();
+    result->stream = global_state->Cast<JalaliResampleGlobalState>().StartStream();
+    result->accumulators.resize(bind_data.value_columns.size());
+    if (!bind_data.value_columns.empty()) {
+        vector<LogicalType> types(bind_data.value_columns.size(), LogicalType::DOUBLE);
+        result->values.Initialize(Allocator::Get(context.client), types);
+        result->exact_values.Initialize(Allocator::Get(context.client), bind_data.sum_types);
+    }
+    return std::move(result);
+}
+
+// Write a period as output row `row`
+static void JalaliResampleEmit(const JalaliResampleBindData &bind_data, int32_t period_id,
+                               const vector<JalaliResampleAccumulator> &accumulators, DataChunk &output, idx_t row) {
+    JalaliWritePeriodKey(output.data[0], row, period_id, bind_data.period);
+    idx_t out_col = 1;
+    for (idx_t v = 0; v < accumulators.size(); v++) {
+        auto &acc = accumulators[v];
+        for (auto agg : bind_data.aggs) {
+            auto &target = output.data[out_col++];
+            if (agg == JalaliResampleAgg::COUNT) {
+                FlatVector::GetData<int64_t>(target)[row] = int64_t(acc.count);
+                continue;
+            }
+            if (acc.count == 0) {
+                FlatVector::SetNull(target, row, true);
+                continue;
+            }
+            if (agg == JalaliResampleAgg::SUM && bind_data.exact_sums[v]) {
+                FlatVector::GetData<hugeint_t>(target)[row] = acc.exact_sum;
+                continue;
+            }
+            auto &value = FlatVector::GetData<double>(target)[row];
+            switch (agg) {
+            case JalaliResampleAgg::SUM:
+                value = acc.sum;
+                break;
+            case JalaliResampleAgg::MIN:
+                value = acc.min;
+                break;
+            case JalaliResampleAgg::MAX:
+                value = acc.max;
+                break;
+            case JalaliResampleAgg::AVG:
+                value = acc.sum / double(acc.count);
+                break;
+            case JalaliResampleAgg::FIRST:
+                value = acc.first;
+                break;
+            default:
+                value = acc.last;
+                break;
+            }
+        }
+    }
+}
+
+// Start accumulating period_id; day keys also cache its day range
+static void JalaliResampleOpen(JalaliResampleLocalState &lstate, int32_t period_id, JalaliPeriod period,
+                               bool day_keys) {
+    lstate.has_period = true;
+    lstate.period_id = period_id;
+    if (day_keys) {
+        lstate.period_begin = JalaliCalendar::PeriodStart(period_id, period);
+        lstate.period_end = JalaliCalendar::PeriodStart(period_id + 1, period);
+    }
+    for (auto &acc : lstate.accumulators) {
+        acc.Reset();
+    }
+}
+
+// Write the settled boundary periods and then the periods closed in the current chunk, as far as they fit; returns
+// whether all of them were written
+static bool JalaliResampleDrain(const JalaliResampleBindData &bind_data, JalaliResampleLocalState &lstate,
+                                DataChunk &output) {
+    idx_t out_count = 0;
+    while (lstate.settled_index < lstate.settled_periods.size() && out_count < STANDARD_VECTOR_SIZE) {
+        auto &entry = lstate.settled_periods[lstate.settled_index++];
+        JalaliResampleEmit(bind_data, entry.first, entry.second, output, out_count++);
+    }
+    if (lstate.settled_index == lstate.settled_periods.size()) {
+        lstate.settled_periods.clear();
+        lstate.settled_index = 0;
+    }
+    auto copy_count = MinValue(lstate.closed.size() - lstate.closed_offset, STANDARD_VECTOR_SIZE - out_count);
+    if (copy_count > 0) {
+        for (idx_t col = 0; col < output.ColumnCount(); col++) {
+            VectorOperations::Copy(lstate.closed.data[col], output.data[col], lstate.closed_offset + copy_count,
+                                   lstate.closed_offset, out_count);
+        }
+        lstate.closed_offset += copy_count;
+        out_count += copy_count;
+    }
+    output.SetCardinality(out_count);
+    if (!lstate.settled_periods.empty() || lstate.closed_offset < lstate.closed.size()) {
+        return false;
+    }
+    lstate.closed.Reset();
+    lstate.closed_offset = 0;
+    return true;
+}
+
+static OperatorResultType JalaliResampleFunction(ExecutionContext &context, TableFunctionInput &data,
+                                                 DataChunk &input, DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<JalaliResampleBindData>();
+    auto &lstate = data.local_state->Cast<JalaliResampleLocalState>();
+    if (!lstate.settled_periods.empty() || lstate.closed.size() > 0) {
+        // The input chunk is done; its output did not all fit in the previous call
+        return JalaliResampleDrain(bind_data, lstate, output) ? OperatorResultType::NEED_MORE_INPUT
+                                                               : OperatorResultType::HAVE_MORE_OUTPUT;
+    }
+    if (lstate.closed.ColumnCount() == 0) {
+        lstate.closed.Initialize(Allocator::Get(context.client), output.GetTypes());
+    }
+    auto count = input.size();
+    auto &key_vector = input.data[bind_data.key_index];
+    auto key_type = key_vector.GetType().id();
+    auto day_keys = key_type != LogicalTypeId::INTEGER;
+
+    UnifiedVectorFormat key_data;
+    key_vector.ToUnifiedFormat(count, key_data);
+    auto timestamps = UnifiedVectorFormat::GetData<timestamp_t>(key_data);
+    auto dates = UnifiedVectorFormat::GetData<date_t>(key_data);
+    auto ids = UnifiedVectorFormat::GetData<int32_t>(key_data);
+
+    auto value_count = bind_data.value_columns.size();
+    vector<UnifiedVectorFormat> value_data(value_count);
+    vector<UnifiedVectorFormat> exact_data(value_count);
+    if (value_count > 0) {
+        lstate.values.Reset();
+        lstate.exact_values.Reset();
+        for (idx_t v = 0; v < value_count; v++) {
+            auto &source = input.data[bind_data.value_columns[v]];
+            auto &target = lstate.values.data[v];
+            if (source.GetType().id() == LogicalTypeId::DOUBLE) {
+                target.Reference(source);
+            } else {
+                VectorOperations::DefaultCast(source, target, count);
+            }
+            target.ToUnifiedFormat(count, value_data[v]);
+            if (bind_data.exact_sums[v]) {
+                auto &exact_target = lstate.exact_values.data[v];
+                if (source.GetType() == bind_data.sum_types[v]) {
+                    exact_target.Reference(source);
+                } else {
+                    VectorOperations::DefaultCast(source, exact_target, count);
+                }
+                exact_target.ToUnifiedFormat(count, exact_data[v]);
+            }
+        }
+    }
+
+    // Periods are not carried over from the previous chunk: the chunks in between may go to other streams.
+    // Every closed period owns at least one input row, so a chunk never closes more periods than fit in a vector.
+    lstate.has_period = false;
+    lstate.first_closed = false;
+    idx_t closed_count = 0;
+    for (idx_t row = 0; row < count; row++) {
+        auto idx = key_data.sel->get_index(row);
+        if (!key_data.validity.RowIsValid(idx)) {
+            continue;
+        }
+        int32_t period_id;
+        int64_t position;
+        if (day_keys) {
+            int32_t days;
+            if (key_type == LogicalTypeId::TIMESTAMP) {
+                int64_t micros;
+                JalaliCalendar::SplitTimestamp(timestamps[idx], days, micros);
+                position = timestamps[idx].value;
+            } else {
+                days = dates[idx].days;
+                position = days;
+            }
+            if (lstate.has_period && days >= lstate.period_begin && days < lstate.period_end) {
+                period_id = lstate.period_id;
+            } else {
+                period_id = JalaliCalendar::PeriodId(days, bind_data.period);
+            }
+        } else {
+            period_id = ids[idx];
+            position = period_id;
+        }
+        if (!lstate.has_period || period_id != lstate.period_id) {
+            if (!lstate.has_period) {
+                lstate.first_period = period_id;
+            } else if (period_id < lstate.period_id) {
+                throw InvalidInputException("jalali_resample: the input must be sorted on the key column");
+            } else if (!lstate.first_closed) {
+                lstate.first_closed = true;
+                lstate.first_accumulators = lstate.accumulators;
+            } else {
+                JalaliResampleEmit(bind_data, lstate.period_id, lstate.accumulators, lstate.closed, closed_count++);
+            }
+            JalaliResampleOpen(lstate, period_id, bind_data.period, day_keys);
+        }
+        for (idx_t v = 0; v < value_count; v++) {
+            auto &values = value_data[v];
+            auto value_idx = values.sel->get_index(row);
+            if (values.validity.RowIsValid(value_idx)) {
+                auto &acc = lstate.accumulators[v];
+                acc.Update(UnifiedVectorFormat::GetData<double>(values)[value_idx], position);
+                if (bind_data.exact_sums[v]) {
+                    auto &exact = exact_data[v];
+                    acc.AddExact(UnifiedVectorFormat::GetData<hugeint_t>(exact)[exact.sel->get_index(row)]);
+                }
+            }
+        }
+    }
+    lstate.closed.SetCardinality(closed_count);
+
+    if (lstate.has_period) {
+        auto &gstate = data.global_state->Cast<JalaliResampleGlobalState>();
+        lock_guard<mutex> guard(gstate.lock);
+        gstate.AddChunk("jalali_resample", lstate.stream, lstate.first_period, lstate.period_id);
+        if (lstate.first_closed) {
+            gstate.Merge(lstate.first_period, lstate.first_accumulators);
+        }
+        gstate.Merge(lstate.period_id, lstate.accumulators);
+        gstate.Settle(nullptr);
+        gstate.TakeSettled(lstate.settled_periods);
+    }
+    return JalaliResampleDrain(bind_data, lstate, output) ? OperatorResultType::NEED_MORE_INPUT
+                                                           : OperatorResultType::HAVE_MORE_OUTPUT;
+}
+
+// A finishing stream no longer holds periods back: it emits the boundary periods that this settles, and the last
+// stream to finish emits all remaining ones
+static OperatorFinalizeResultType JalaliResampleFinal(ExecutionContext &context, TableFunctionInput &data,
+                                                      DataChunk &output) {
+    auto &bind_data = data.bind_data->Cast<JalaliResampleBindData>();
+    auto &lstate = data.local_state->Cast<JalaliResampleLocalState>();
+    if (!lstate.finished) {
+        lstate.finished = true;
+        auto &gstate = data.global_state->Cast<JalaliResampleGlobalState>();
+        lock_guard<mutex> guard(gstate.lock);
+        gstate.FinishStream(lstate.stream);
+        gstate.Settle(nullptr);
+        gstate.TakeSettled(lstate.settled_periods);
+    }
+    return JalaliResampleDrain(bind_data, lstate, output) ? OperatorFinalizeResultType::FINISHED
+                                                           : OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+}
+
+void JalaliFunctions::RegisterSeriesFunctions(DatabaseInstance &instance) {
+    TableFunction fill_gaps_function("jalali_fill_gaps", {LogicalType::TABLE}, nullptr, JalaliFillGapsBind,
+                                     JalaliStreamInitGlobal, JalaliFillGapsInitLocal);
+    fill_gaps_function.in_out_function = JalaliFillGapsFunction;
+    fill_gaps_function.in_out_function_final = JalaliFillGapsFinal;
+    fill_gaps_function.named_parameters["period"] = LogicalType::VARCHAR;
+    fill_gaps_function.named_parameters["key"] = LogicalType::VARCHAR;
+    fill_gaps_function.named_parameters["default"] = LogicalType::ANY;
+    ExtensionUtil::RegisterFunction(instance, fill_gaps_function);
+
+    TableFunction resample_function("jalali_resample", {LogicalType::TABLE}, nullptr, JalaliResampleBind,
+                                    JalaliResampleInitGlobal, JalaliResampleInitLocal);
+    resample_function.in_out_function = JalaliResampleFunction;
+    resample_function.in_out_function_final = JalaliResampleFinal;
+    resample_function.named_parameters["period"] = LogicalType::VARCHAR;
+    resample_function.named_parameters["key"] = LogicalType::VARCHAR;
+    resample_function.named_parameters["aggs"] = LogicalType::LIST(LogicalType::VARCHAR);
+    ExtensionUtil::RegisterFunction(instance, resample_function);
+}
+
+} // namespace duckdb
@@ -0,0 +1,45 @@
+#include "jalali_functions.hpp"
+#include "jalali_adaptive.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+// jalali_stats(): the conversion strategies chosen by the adaptive kernels of this database
+struct JalaliStatsState : public GlobalTableFunctionState {
+    bool finished = false;
+};
+
+static unique_ptr<FunctionData> JalaliStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"strategy", "decisions", "vectors", "rows"};
+    return_types = {LogicalType::VARCHAR, LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::UBIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> JalaliStatsInit(ClientContext &context, TableFunctionInitInput &input) {
+    return make_uniq<JalaliStatsState>();
+}
+
+static void JalaliStatsFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<JalaliStatsState>();
+    if (state.finished) {
+        return;
+    }
+    auto stats = JalaliStats::Get(context);
+    for (idx_t s = 0; s < JalaliStats::STRATEGY_COUNT; s++) {
+        output.SetValue(0, s, Value(JalaliStats::StrategyName(s)));
+        output.SetValue(1, s, Value::UBIGINT(stats->decisions[s].load()));
+        output.SetValue(2, s, Value::UBIGINT(stats->vectors[s].load()));
+        output.SetValue(3, s, Value::UBIGINT(stats->rows[s].load()));
+    }
+    output.SetCardinality(JalaliStats::STRATEGY_COUNT);
+    state.finished = true;
+}
+
+void JalaliFunctions::RegisterStatsFunctions(DatabaseInstance &instance) {
+    TableFunction stats_function("jalali_stats", {}, JalaliStatsFunction, JalaliStatsBind, JalaliStatsInit);
+    ExtensionUtil::RegisterFunction(instance, stats_function);
+}
+
+} // namespace duckdb
@@ -0,0 +1,101 @@
+// Tests of the header-only JalaliAppender API: values appended from Jalali text and parts are stored as the
+// expected DATE/TIMESTAMP, and invalid input is rejected before anything is appended
+#include "duckdb.hpp"
+#include "jalali_appender.hpp"
+
+#include <functional>
+#include <iostream>
+
+using namespace duckdb;
+
+static int failures = 0;
+
+static void Check(bool condition, const string &description) {
+    if (!condition) {
+        std::cerr << "FAILED: " << description << std::endl;
+        failures++;
+    }
+}
+
+static void CheckValue(MaterializedQueryResult &result, idx_t column, idx_t row, const Value &expected) {
+    auto actual = result.GetValue(column, row);
+    Check(actual == expected, StringUtil::Format("row %llu column %llu: expected %s, got %s", row, column,
+                                                 expected.ToString(), actual.ToString()));
+}
+
+// The call has to throw an InvalidInputException that mentions `message`
+static void CheckThrows(const std::function<void()> &call, const string &message) {
+    try {
+        call();
+    } catch (std::exception &ex) {
+        ErrorData error(ex);
+        Check(error.Type() == ExceptionType::INVALID_INPUT && StringUtil::Contains(error.RawMessage(), message),
+              "expected an error about \"" + message + "\", got: " + error.Message());
+        return;
+    }
+    Check(false, "expected an error about \"" + message + "\"");
+}
+
+int main() {
+    DuckDB db(nullptr);
+    Connection con(db);
+    con.Query("CREATE TABLE events (id INTEGER, day DATE, ts TIMESTAMP)");
+
+    {
+        Appender appender(con, "events");
+        JalaliAppender jalali(appender);
+        jalali.BeginRow();
+        jalali.Append<int32_t>(1);
+        jalali.AppendJalaliDate("1402-05-12");
+        jalali.AppendJalaliTimestamp("1402-05-12 10:15:30");
+        jalali.EndRow();
+
+        // Esfand 30 of the leap year 1403, and date parts with microseconds
+        jalali.BeginRow();
+        jalali.Append<int32_t>(2);
+        jalali.AppendJalaliDate(1403, 12, 30);
+        jalali.AppendJalaliTimestamp(1402, 1, 1, 0, 0, 0, 500000);
+        jalali.EndRow();
+
+        // A UTC offset is normalized to UTC
+        jalali.BeginRow();
+        jalali.Append<int32_t>(3);
+        jalali.AppendNull();
+        jalali.AppendJalaliTimestamp("1402-05-12T10:15:30+03:30");
+        jalali.EndRow();
+
+        // Nothing is appended for invalid input
+        CheckThrows([&]() { jalali.AppendJalaliDate("not a date"); }, "Invalid Jalali date format");
+        CheckThrows([&]() { jalali.AppendJalaliDate("1402-13-01"); }, "Invalid Jalali date");
+        CheckThrows([&]() { jalali.AppendJalaliDate(1402, 12, 30); }, "Invalid Jalali date");
+        CheckThrows([&]() { jalali.AppendJalaliDate("1402-05-12 10:00"); }, "without time");
+        CheckThrows([&]() { jalali.AppendJalaliTimestamp(1402, 1, 1, 24, 0, 0); }, "Invalid time");
+        CheckThrows([&]() { jalali.AppendJalaliDate("999999-01-01"); }, "Jalali date out of range");
+        CheckThrows([&]() { jalali.AppendJalaliDate(-999999, 1, 1); }, "Jalali date out of range");
+        CheckThrows([&]() { jalali.AppendJalaliTimestamp(299000, 1, 1, 0, 0, 0); }, "outside the TIMESTAMP range");
+        CheckThrows([&]() { jalali.AppendJalaliTimestamp("299000-01-01 10:00"); }, "outside the TIMESTAMP range");
+        jalali.Close();
+    }
+
+    auto result = con.Query("SELECT id, day, ts FROM events ORDER BY id");
+    if (result->HasError()) {
+        std::cerr << "FAILED: " << result->GetError() << std::endl;
+        return 1;
+    }
+    Check(result->RowCount() == 3, StringUtil::Format("expected 3 rows, got %llu", result->RowCount()));
+    if (result->RowCount() == 3) {
+        CheckValue(*result, 1, 0, Value::DATE(2023, 8, 3));
+        CheckValue(*result, 2, 0, Value::TIMESTAMP(2023, 8, 3, 10, 15, 30, 0));
+        CheckValue(*result, 1, 1, Value::DATE(2025, 3, 20));
+        CheckValue(*result, 2, 1, Value::TIMESTAMP(2023, 3, 21, 0, 0, 0, 500000));
+        Check(result->GetValue(1, 2).IsNull(), "row 2 column 1: expected NULL");
+        CheckValue(*result, 2, 2, Value::TIMESTAMP(2023, 8, 3, 6, 45, 30, 0));
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All JalaliAppender checks passed" << std::endl;
+    return 0;
+}